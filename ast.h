@@ -5,15 +5,157 @@
 // DESC: AST types for MyPL implementation. Each AST node is
 //       implemented as POD (plain old data) types, with all data
 //       public, with the exception of the visitor abstraction (i.e.,
-//       the accept function) and a destrutor for dynamic memory. Note
-//       that some liberties are taken with formatting to keep the
-//       file size manageable.
+//       the accept function). Note that some liberties are taken with
+//       formatting to keep the file size manageable. Variable
+//       references carry the frame slot, field paths the number of
+//       each step's field site (the field's type and offset), and
+//       literals their decoded values, assigned to them by the type
+//       checker. Nodes are allocated from an arena owned by the
+//       Program, and child sequences are stored as contiguous spans
+//       in the same arena, so the whole tree is freed at once.
 //----------------------------------------------------------------------
 
 #ifndef AST_H
 #define AST_H
 
-#include <list>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "data_object.h"
+#include "token.h"
+
+
+//----------------------------------------------------------------------
+// AST storage
+//----------------------------------------------------------------------
+
+// a contiguous sequence of children, stored in an ASTArena (the
+// arena owns the memory, the span its elements)
+template<typename T>
+class Span
+{
+public:
+  Span() {}
+  ~Span() {clear();}
+  // elements live in arena memory, so spans aren't copied
+  Span(const Span&) = delete;
+  Span& operator=(const Span&) = delete;
+  // element access
+  T* begin() {return items;}
+  T* end() {return items + count;}
+  const T* begin() const {return items;}
+  const T* end() const {return items + count;}
+  size_t size() const {return count;}
+  bool empty() const {return count == 0;}
+  T& front() {return items[0];}
+  T& back() {return items[count - 1];}
+  T& operator[](size_t i) {return items[i];}
+  const T& operator[](size_t i) const {return items[i];}
+private:
+  friend class ASTArena;
+  void clear()
+  {
+    if (!std::is_trivially_destructible<T>::value)
+      for (size_t i = 0; i < count; ++i)
+        items[i].~T();
+    count = 0;
+  }
+  T* items = nullptr;
+  size_t count = 0;
+  size_t capacity = 0;
+};
+
+
+// bump-pointer allocator for AST nodes and spans; nodes are destroyed
+// (in reverse order) and all memory released when the arena is
+class ASTArena
+{
+public:
+  ASTArena() {}
+  ~ASTArena()
+  {
+    for (size_t i = cleanups.size(); i > 0; --i)
+      cleanups[i-1].destroy(cleanups[i-1].object);
+    for (char* block : blocks)
+      delete[] block;
+  }
+  // the arena owns the nodes, so it can't be copied
+  ASTArena(const ASTArena&) = delete;
+  ASTArena& operator=(const ASTArena&) = delete;
+
+  // construct a new T in the arena
+  template<typename T, typename... Args>
+  T* make(Args&&... args)
+  {
+    T* object = new (allocate(sizeof(T), alignof(T)))
+      T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value)
+      cleanups.push_back({object, [](void* p) {static_cast<T*>(p)->~T();}});
+    return object;
+  }
+
+  // add an item to the end of a span, moving the span to twice the
+  // room when full (the old storage is reclaimed with the arena)
+  template<typename T, typename U>
+  void append(Span<T>& span, U&& item)
+  {
+    if (span.count == span.capacity) {
+      size_t capacity = span.capacity ? 2 * span.capacity : 2;
+      T* items = static_cast<T*>(allocate(capacity * sizeof(T), alignof(T)));
+      for (size_t i = 0; i < span.count; ++i)
+        new (&items[i]) T(std::move(span.items[i]));
+      size_t count = span.count;
+      span.clear();
+      span.items = items;
+      span.count = count;
+      span.capacity = capacity;
+    }
+    new (&span.items[span.count++]) T(std::forward<U>(item));
+  }
+
+  // total bytes of arena blocks
+  size_t bytes() const {return total;}
+
+private:
+  static const size_t BLOCK_SIZE = 64 * 1024;
+
+  // aligned raw memory from the current block (or a new one)
+  void* allocate(size_t size, size_t align)
+  {
+    size_t start = (used + align - 1) & ~(align - 1);
+    if (blocks.empty() or start + size > block_size) {
+      block_size = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+      blocks.push_back(new char[block_size]);
+      total += block_size;
+      start = 0;
+    }
+    used = start + size;
+    return blocks.back() + start;
+  }
+
+  struct Cleanup {
+    void* object;
+    void (*destroy)(void*);
+  };
+
+  std::vector<char*> blocks;     // memory blocks, the last is current
+  size_t block_size = 0;         // size of the current block
+  size_t used = 0;               // bytes used in the current block
+  size_t total = 0;
+  std::vector<Cleanup> cleanups; // destructors to run, in order made
+};
+
+
+// the field a step of a field path reads or writes, as resolved by
+// the type checker: the type that owns it and its offset in that type
+struct FieldSite
+{
+  Symbol type;
+  int offset;
+};
+
 
 //----------------------------------------------------------------------
 // Visitor interface
@@ -115,6 +257,22 @@ public:
 // Expressions and Expression Terms
 //----------------------------------------------------------------------
 
+// binary operations (resolved from the operator token by the parser)
+enum class BinOp {NONE, ADD, SUB, MUL, DIV, MOD, AND, OR, EQ, NE,
+                  LT, LE, GT, GE};
+
+// binary operations specialized to their operands' static types
+// (chosen by the type checker); GENERIC dispatches on the values
+enum class Kernel {GENERIC,
+                   INT_ADD, INT_SUB, INT_MUL, INT_DIV, INT_MOD,
+                   INT_EQ, INT_NE, INT_LT, INT_LE, INT_GT, INT_GE,
+                   DOUBLE_ADD, DOUBLE_SUB, DOUBLE_MUL, DOUBLE_DIV,
+                   DOUBLE_LT, DOUBLE_LE, DOUBLE_GT, DOUBLE_GE,
+                   STRING_CONCAT};
+
+// An Expr with an operator is one binary operation: first is the left
+// operand (a ComplexTerm when it is itself an operation) and rest the
+// right operand, grouped by operator precedence.
 
 class Expr : public ASTNode
 {
@@ -122,9 +280,9 @@ public:
   bool negated = false;         // true if not precedes "expression"
   ExprTerm* first = nullptr;    // the first term
   Token* op = nullptr;          // optional operator
+  BinOp bin_op = BinOp::NONE;   // the operator's operation
+  Kernel kernel = Kernel::GENERIC; // the operation for the operand types
   Expr* rest = nullptr;         // expression after operator (if exists)
-  // cleanup
-  ~Expr() {delete first; delete op; delete rest;}
   // get first token
   Token first_token() {return first->first_token();}
   // visitor access
@@ -136,8 +294,6 @@ class SimpleTerm : public ExprTerm
 {
 public:
   RValue* rvalue = nullptr;     // one rvalue ("base case")
-  // cleanup memory
-  ~SimpleTerm() {delete rvalue;}
   // return first token
   Token first_token() {return rvalue->first_token();}  
   // visitor access
@@ -149,8 +305,6 @@ class ComplexTerm : public ExprTerm
 {
 public:
   Expr* expr = nullptr;         // term is another expression
-  // cleanup memory
-  ~ComplexTerm() {delete expr;}
   // return first token
   Token first_token() {return expr->first->first_token();}  
   // visitor access
@@ -166,9 +320,10 @@ public:
 class Program : public ASTNode
 {
 public:
-  std::list<Decl*> decls;       //  list of declarations
-  // cleanup memory
-  ~Program() {for (Decl* d : decls) delete d;}
+  ASTArena arena;               // storage for the whole tree
+  Span<Decl*> decls;            // list of declarations
+  Span<FieldSite> field_sites;  // one per field path step, numbered
+                                // in the order the checker saw them
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -180,10 +335,9 @@ public:
   struct FunParam {Token id; Token type;}; // function parameter type
   Token return_type;                       // function return type
   Token id;                                // function name
-  std::list<FunParam> params;              // function params
-  std::list<Stmt*> stmts;                  // function body 
-  // cleanup memory
-  ~FunDecl() {for (Stmt* s : stmts) delete s;}
+  Span<FunParam> params;                   // function params
+  Span<Stmt*> stmts;                       // function body
+  int frame_size = 0;                      // local slots (params first)
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -196,8 +350,8 @@ public:
   Token id;                     // variable name
   Expr* expr = nullptr;         // variable initialization expression
   bool pointer = false;
-  // cleanup memory
-  ~VarDeclStmt() {delete type; delete expr;}
+  int slot = -1;                // frame slot of the variable
+  int cell = -1;                // slot a ~ variable set to a value points at
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -207,9 +361,8 @@ class TypeDecl : public Decl
 {
 public:
   Token id;                       // type name
-  std::list<VarDeclStmt*> vdecls; // variable declarations
-  // cleanup memory
-  ~TypeDecl() {for (VarDeclStmt* v : vdecls) delete v;}
+  Span<VarDeclStmt*> vdecls;      // variable declarations
+  int frame_size = 0;             // slots used by field initializers
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -223,10 +376,11 @@ public:
 class AssignStmt : public Stmt
 {
 public:
-  std::list<Token> lvalue_list; // lhs as one or more ids
+  Span<Token> lvalue_list;      // lhs as one or more ids
   Expr* expr = nullptr;         // rhs expression
-  // cleanup memory
-  ~AssignStmt() {delete expr;}
+  int slot = -1;                // frame slot of the first lhs id
+  int site = -1;                // field site of the second lhs id (the
+                                // later ids take the sites after it)
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };
@@ -236,8 +390,6 @@ class ReturnStmt : public Stmt
 {
 public:
   Expr* expr = nullptr;         // return expression
-  // cleanup memory
-  ~ReturnStmt() {delete expr;}
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -248,9 +400,7 @@ class BasicIf
 {
 public:
   Expr* expr = nullptr;   // boolean expression
-  std::list<Stmt*> stmts; // body statements
-  // cleanup memory
-  ~BasicIf() {delete expr; for (Stmt* s : stmts) delete s;}
+  Span<Stmt*> stmts;      // body statements
 };
 
 
@@ -258,17 +408,8 @@ class IfStmt : public Stmt
 {
 public:
   BasicIf* if_part = nullptr;   // if part
-  std::list<BasicIf*> else_ifs; // else ifs
-  std::list<Stmt*> body_stmts;  // else body (if empty, no else)
-  // cleanup memory
-  ~IfStmt()
-  {
-    delete if_part;
-    for (BasicIf* s : else_ifs)
-      delete s;
-    for (Stmt* s : body_stmts)
-      delete s;
-  }
+  Span<BasicIf*> else_ifs;      // else ifs
+  Span<Stmt*> body_stmts;       // else body (if empty, no else)
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -278,9 +419,7 @@ class WhileStmt : public Stmt
 {
 public:
   Expr* expr = nullptr;         // boolean expression
-  std::list<Stmt*> stmts;       // body statements
-  // cleanup memory
-  ~WhileStmt() {delete expr; for (Stmt* s : stmts) delete s;}
+  Span<Stmt*> stmts;            // body statements
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -290,11 +429,11 @@ class ForStmt : public Stmt
 {
 public:
   Token var_id;                 // loop variable
+  int slot = -1;                // frame slot of the loop variable
   Expr* start;                  // loop start expression
   Expr* end;                    // loop end expression
-  std::list<Stmt*> stmts;       // loop body
-  // cleanup memory
-  ~ForStmt() {delete start; delete end; for (Stmt* s : stmts) delete s;}
+  Span<Stmt*> stmts;            // loop body
+  bool counted = false;         // int bounds, variable not set in body
   // visitor access
   void accept(Visitor& v) {v.visit(*this);}
 };  
@@ -309,6 +448,8 @@ class SimpleRValue : public RValue
 {
 public:
   Token value;                  // primitive value
+  DataObject val;               // the decoded value (set at check time)
+  bool decoded = false;         // false if not decoded (out of range)
   // return first token
   Token first_token() {return value;}  
   // visitor access
@@ -331,9 +472,8 @@ class CallExpr : public RValue, public Stmt
 {
 public:
   Token function_id;            // function name being called
-  std::list<Expr*> arg_list;    // call arguments
-  // cleanup memory
-  ~CallExpr() {for(Expr* e : arg_list) delete e;}
+  Span<Expr*> arg_list;         // call arguments
+  bool tail = false;            // returned as is (can reuse the frame)
   // return first token
   Token first_token() {return function_id;}  
   // visitor access
@@ -344,7 +484,10 @@ public:
 class IDRValue : public RValue
 {
 public:
-  std::list<Token> path;        // one or more ids (path expression)
+  Span<Token> path;             // one or more ids (path expression)
+  int slot = -1;                // frame slot of the first id
+  int site = -1;                // field site of the second id (the
+                                // later ids take the sites after it)
   // return first token
   Token first_token() {return path.front();}  
   // visitor access
@@ -356,8 +499,6 @@ class NegatedRValue : public RValue
 {
 public:
   Expr* expr = nullptr;         // negated expression
-  // cleanup memory
-  ~NegatedRValue() {delete expr;}
   // return first token
   Token first_token() {return expr->first->first_token();}  
   // visitor access
@@ -368,6 +509,7 @@ class PointerType : public RValue
 {
   public:
   Token pointer;
+  int slot = -1;                // frame slot of the pointer variable
   // return first token
   Token first_token() {return pointer;}  
   // visitor access
@@ -378,6 +520,7 @@ class PointerValue : public RValue
 {
 public:
   Token pointer;
+  int slot = -1;                // frame slot of the referenced variable
   // return first token
   Token first_token() {return pointer;}  
   // visitor access
@@ -0,0 +1,348 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: bench.cpp
+// DATE: 10/17/2026
+// DESC: Benchmark driver for MyPL. Runs each workload several times,
+//       each run in a forked child so peak RSS is per run, and
+//       reports min/median/p99 wall time, peak RSS, allocations and
+//       the field inline cache hit rate as a table and (optionally)
+//       as JSON.
+//
+//       usage: mypl-bench [--vm] [--no-optimize] [--runs N]
+//                         [--json FILE] [file ...]
+//
+//       With no files, every .mypl file in the bench directory is run.
+//       mypl-bench-switch is the same driver built with the VM's
+//       switch dispatch, for comparing against the threaded default.
+//----------------------------------------------------------------------
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "token.h"
+#include "mypl_exception.h"
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "type_checker.h"
+#include "optimizer.h"
+#include "interpreter.h"
+#include "compiler.h"
+#include "peephole.h"
+#include "vm.h"
+
+using namespace std;
+
+
+//----------------------------------------------------------------------
+// allocation counting (every operator new in the process)
+//----------------------------------------------------------------------
+
+static size_t alloc_count = 0;
+static size_t alloc_bytes = 0;
+
+void* operator new(size_t size)
+{
+  ++alloc_count;
+  alloc_bytes += size;
+  void* ptr = malloc(size ? size : 1);
+  if (!ptr)
+    throw bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  free(ptr);
+}
+
+
+//----------------------------------------------------------------------
+// running the workloads
+//----------------------------------------------------------------------
+
+// what a child run reports back through its pipe
+struct RunResult
+{
+  double ms = 0.0;          // parse, check, and run time
+  size_t allocs = 0;        // number of allocations
+  size_t bytes = 0;         // bytes allocated
+  FieldCacheStats fields;   // field inline cache hits and misses
+  long peak_rss_kb = 0;     // filled in by the parent
+  bool ok = false;
+};
+
+
+// one workload's summary over all runs
+struct BenchResult
+{
+  string name;
+  vector<RunResult> runs;
+  double min_ms = 0.0;
+  double median_ms = 0.0;
+  double p99_ms = 0.0;
+  long peak_rss_kb = 0;
+  size_t allocs = 0;
+  size_t bytes = 0;
+  FieldCacheStats fields;
+};
+
+
+// how each workload is run
+struct RunConfig {
+  bool use_vm = false;      // the VM instead of the tree walker
+  bool optimize = true;     // fold constants (and fuse VM instructions)
+};
+
+
+// run the program in the current process (in the child), discarding
+// its output
+RunResult run_program(const string& file, const RunConfig& config)
+{
+  RunResult result;
+  auto start = chrono::steady_clock::now();
+  alloc_count = 0;
+  alloc_bytes = 0;
+  try {
+    Lexer lexer(file);
+    Parser parser(lexer);
+    Program ast_root_node;
+    parser.parse(ast_root_node);
+    TypeChecker type_checker;
+    ast_root_node.accept(type_checker);
+    if (config.optimize) {
+      Optimizer optimizer(ast_root_node.arena);
+      ast_root_node.accept(optimizer);
+    }
+    if (config.use_vm) {
+      Bytecode bytecode;
+      Compiler compiler(bytecode);
+      ast_root_node.accept(compiler);
+      if (config.optimize) {
+        Peephole peephole;
+        peephole.run(bytecode);
+      }
+      VM vm(bytecode);
+      vm.run();
+      result.fields = vm.get_field_stats();
+    }
+    else {
+      Interpreter interpreter;
+      ast_root_node.accept(interpreter);
+      result.fields = interpreter.get_field_stats();
+    }
+    result.ok = true;
+  } catch (MyPLException e) {
+    cerr << file << ": " << e.to_string() << endl;
+  }
+  cout.flush();
+  chrono::duration<double,milli> elapsed = chrono::steady_clock::now() - start;
+  result.ms = elapsed.count();
+  result.allocs = alloc_count;
+  result.bytes = alloc_bytes;
+  return result;
+}
+
+
+// run the program once in a child process
+RunResult run_once(const string& file, const RunConfig& config)
+{
+  RunResult result;
+  int fds[2];
+  if (pipe(fds) != 0)
+    return result;
+  pid_t pid = fork();
+  if (pid == 0) {
+    close(fds[0]);
+    int null_fd = open("/dev/null", O_RDWR);
+    dup2(null_fd, STDIN_FILENO);
+    dup2(null_fd, STDOUT_FILENO);
+    RunResult child = run_program(file, config);
+    ssize_t n = write(fds[1], &child, sizeof(child));
+    _exit(n == sizeof(child) ? 0 : 1);
+  }
+  close(fds[1]);
+  ssize_t n = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status = 0;
+  struct rusage usage;
+  if (pid < 0 or wait4(pid, &status, 0, &usage) < 0 or
+      n != sizeof(result) or !WIFEXITED(status) or WEXITSTATUS(status))
+    result.ok = false;
+  else
+    result.peak_rss_kb = usage.ru_maxrss;
+  return result;
+}
+
+
+// nearest-rank percentile of sorted times
+double percentile(const vector<double>& sorted, double p)
+{
+  size_t rank = (size_t) ceil(p * sorted.size());
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+
+// run a workload the given number of times and summarize it
+bool run_bench(const string& file, const RunConfig& config, int runs,
+               BenchResult& bench)
+{
+  size_t slash = file.find_last_of('/');
+  bench.name = file.substr(slash == string::npos ? 0 : slash + 1);
+  vector<double> times;
+  for (int i = 0; i < runs; ++i) {
+    RunResult run = run_once(file, config);
+    if (!run.ok)
+      return false;
+    bench.runs.push_back(run);
+    times.push_back(run.ms);
+    bench.peak_rss_kb = max(bench.peak_rss_kb, run.peak_rss_kb);
+  }
+  sort(times.begin(), times.end());
+  bench.min_ms = times.front();
+  bench.median_ms = percentile(times, 0.5);
+  bench.p99_ms = percentile(times, 0.99);
+  // allocation and cache counts are deterministic, so any run will do
+  bench.allocs = bench.runs.front().allocs;
+  bench.bytes = bench.runs.front().bytes;
+  bench.fields = bench.runs.front().fields;
+  return true;
+}
+
+
+// the .mypl files in a directory, in name order
+vector<string> bench_files(const string& dir)
+{
+  vector<string> files;
+  DIR* d = opendir(dir.c_str());
+  if (!d)
+    return files;
+  while (struct dirent* entry = readdir(d)) {
+    string name = entry->d_name;
+    if (name.size() > 5 and name.substr(name.size() - 5) == ".mypl")
+      files.push_back(dir + "/" + name);
+  }
+  closedir(d);
+  sort(files.begin(), files.end());
+  return files;
+}
+
+
+//----------------------------------------------------------------------
+// reporting
+//----------------------------------------------------------------------
+
+// percent of field accesses that hit their site's cache (0 if none)
+double hit_rate(const FieldCacheStats& fields)
+{
+  size_t total = fields.hits + fields.misses;
+  return total ? 100.0 * fields.hits / total : 0.0;
+}
+
+
+void print_table(const vector<BenchResult>& results, ostream& out)
+{
+  char line[160];
+  snprintf(line, sizeof(line), "%-22s %10s %10s %10s %10s %12s %14s %10s",
+           "benchmark", "min ms", "median ms", "p99 ms", "rss KB",
+           "allocs", "alloc bytes", "ic hit %");
+  out << line << endl;
+  for (const BenchResult& b : results) {
+    snprintf(line, sizeof(line),
+             "%-22s %10.2f %10.2f %10.2f %10ld %12zu %14zu %10.2f",
+             b.name.c_str(), b.min_ms, b.median_ms, b.p99_ms, b.peak_rss_kb,
+             b.allocs, b.bytes, hit_rate(b.fields));
+    out << line << endl;
+  }
+}
+
+
+void print_json(const vector<BenchResult>& results, const RunConfig& config,
+                int runs, ostream& out)
+{
+  out << "{" << endl;
+  out << "  \"engine\": \"" << (config.use_vm ? "vm" : "walker") << "\","
+      << endl;
+  if (config.use_vm)
+    out << "  \"dispatch\": \"" << VM_DISPATCH << "\"," << endl;
+  out << "  \"optimize\": " << (config.optimize ? "true" : "false") << ","
+      << endl;
+  out << "  \"runs\": " << runs << "," << endl;
+  out << "  \"benchmarks\": [" << endl;
+  for (size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& b = results[i];
+    out << "    {\"name\": \"" << b.name << "\""
+        << ", \"min_ms\": " << b.min_ms
+        << ", \"median_ms\": " << b.median_ms
+        << ", \"p99_ms\": " << b.p99_ms
+        << ", \"peak_rss_kb\": " << b.peak_rss_kb
+        << ", \"allocations\": " << b.allocs
+        << ", \"alloc_bytes\": " << b.bytes
+        << ", \"field_cache_hits\": " << b.fields.hits
+        << ", \"field_cache_misses\": " << b.fields.misses
+        << ", \"times_ms\": [";
+    for (size_t j = 0; j < b.runs.size(); ++j)
+      out << (j ? ", " : "") << b.runs[j].ms;
+    out << "]}" << (i + 1 < results.size() ? "," : "") << endl;
+  }
+  out << "  ]" << endl;
+  out << "}" << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+  RunConfig config;
+  int runs = 5;
+  string json_file;
+  vector<string> files;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "--vm")
+      config.use_vm = true;
+    else if (arg == "--no-optimize")
+      config.optimize = false;
+    else if (arg == "--runs" and i + 1 < argc)
+      runs = max(1, atoi(argv[++i]));
+    else if (arg == "--json" and i + 1 < argc)
+      json_file = argv[++i];
+    else
+      files.push_back(arg);
+  }
+  if (files.empty())
+    files = bench_files(MYPL_BENCH_DIR);
+  if (files.empty()) {
+    cerr << "mypl-bench: no workloads found" << endl;
+    return 1;
+  }
+
+  int ret_code = 0;
+  vector<BenchResult> results;
+  for (const string& file : files) {
+    BenchResult bench;
+    if (run_bench(file, config, runs, bench))
+      results.push_back(bench);
+    else {
+      cerr << "mypl-bench: " << file << " failed" << endl;
+      ret_code = 1;
+    }
+  }
+  print_table(results, cout);
+  if (!json_file.empty()) {
+    ofstream out(json_file);
+    print_json(results, config, runs, out);
+  }
+  return ret_code;
+}
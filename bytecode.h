@@ -0,0 +1,169 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: bytecode.h
+// DATE: 10/17/2026
+// DESC: Instruction set and code objects for the MyPL stack VM. The
+//       compiler translates each function (and each user-defined
+//       type's field initializers) into a CodeObject holding a flat
+//       instruction array, and the VM executes them.
+//----------------------------------------------------------------------
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "data_object.h"
+#include "heap.h"
+
+
+// MyPL VM instructions (the argument meaning is given per group; the
+// VM's dispatch table lists them in this order, ending with OP_READ)
+enum OpCode {
+  // constants and stack (arg: constant index)
+  OP_CONST, OP_NIL, OP_POP,
+  // local variables and references (arg: frame slot)
+  OP_LOAD, OP_STORE, OP_ADDR, OP_LOAD_REF, OP_STORE_REF,
+  // user-defined type objects (arg: type index or field site; each
+  // field access has a site of its own, giving the field's type and
+  // offset, so the VM can keep an inline cache per site)
+  OP_ALLOC, OP_GET_FIELD, OP_SET_FIELD,
+  // math and logical operators (no arg)
+  OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD, OP_AND, OP_OR, OP_NOT, OP_NEG,
+  // comparators (no arg)
+  OP_EQ, OP_NE, OP_LT, OP_LE, OP_GT, OP_GE,
+  // operators specialized to statically typed operands (no arg)
+  OP_ADD_INT, OP_SUB_INT, OP_MUL_INT, OP_DIV_INT, OP_MOD_INT,
+  OP_EQ_INT, OP_NE_INT, OP_LT_INT, OP_LE_INT, OP_GT_INT, OP_GE_INT,
+  OP_ADD_DOUBLE, OP_SUB_DOUBLE, OP_MUL_DOUBLE, OP_DIV_DOUBLE,
+  OP_LT_DOUBLE, OP_LE_DOUBLE, OP_GT_DOUBLE, OP_GE_DOUBLE, OP_CONCAT,
+  // control flow (arg: instruction index or function index); a tail
+  // call replaces the caller's frame with the callee's
+  OP_JUMP, OP_JUMP_IF_FALSE, OP_CALL, OP_RET, OP_TAIL_CALL,
+  // short-circuit and/or: jump if the (kept) top of stack decides
+  OP_JUMP_IF_FALSE_KEEP, OP_JUMP_IF_TRUE_KEEP,
+  // counting loops over an int variable (arg: instruction index, arg2:
+  // the loop variable's slot; the bound is on top of the stack)
+  OP_FOR_ENTER, OP_FOR_NEXT,
+  // superinstructions made by the peephole pass: slot arg += or -= the
+  // int arg2; push slot arg + or - the int arg2; push or pop into the
+  // field at site arg2 of the object in slot arg; and an int comparison
+  // (arg2 is its opcode) that jumps to arg if false
+  OP_INC_LOCAL, OP_DEC_LOCAL, OP_LOAD_ADD_CONST, OP_LOAD_SUB_CONST,
+  OP_LOAD_FIELD, OP_STORE_FIELD, OP_CMP_JUMP_INT,
+  // built-in functions (no arg)
+  OP_PRINT, OP_STOI, OP_STOD, OP_ITOS, OP_DTOS, OP_GET, OP_LENGTH, OP_READ
+};
+
+
+// the generic operator a specialized one stands for (used when an
+// operand turns out to be nil)
+OpCode generic_op(OpCode op);
+
+
+// true if the op's arg is an instruction index
+bool is_jump(OpCode op);
+
+
+// a single instruction
+struct Instr
+{
+  OpCode op;
+  int arg;
+  int arg2;                         // second operand (0 if unused)
+};
+
+
+// the compiled form of a function body
+class CodeObject
+{
+public:
+  std::string name;                 // function (or type) name
+  int num_params = 0;               // parameters occupy the first slots
+  int num_locals = 0;               // total frame slots (incl. params)
+  bool is_init = false;             // a type initializer (not a function)
+  std::vector<Instr> instrs;        // the instruction stream
+  std::vector<int> lines;           // source line of each instruction
+  std::vector<int> columns;         // source column of each instruction
+  std::vector<DataObject> consts;   // constant pool
+
+  // append an instruction, returning its index
+  int emit(OpCode op, int arg, int line, int column, int arg2 = 0);
+
+  // add a constant to the pool, returning its index
+  int add_const(const DataObject& val);
+};
+
+
+// the field a field site accesses: its offset in the type (shape)
+// with the given index
+struct FieldRef
+{
+  int type;
+  int offset;
+};
+
+
+// a compiled program
+class Bytecode
+{
+public:
+  std::vector<CodeObject> functions;                // all code objects
+  std::unordered_map<std::string,int> function_ids; // name to index
+  std::vector<int> type_inits;                      // type to initializer
+  std::vector<Shape> shapes;                        // type to field layout
+  std::vector<FieldRef> field_sites;                // field of each site
+  int main_id = -1;                                 // index of main
+};
+
+
+OpCode generic_op(OpCode op)
+{
+  switch (op) {
+    case OP_ADD_INT: case OP_ADD_DOUBLE: case OP_CONCAT: return OP_ADD;
+    case OP_SUB_INT: case OP_SUB_DOUBLE: return OP_SUB;
+    case OP_MUL_INT: case OP_MUL_DOUBLE: return OP_MUL;
+    case OP_DIV_INT: case OP_DIV_DOUBLE: return OP_DIV;
+    case OP_MOD_INT: return OP_MOD;
+    case OP_EQ_INT: return OP_EQ;
+    case OP_NE_INT: return OP_NE;
+    case OP_LT_INT: case OP_LT_DOUBLE: return OP_LT;
+    case OP_LE_INT: case OP_LE_DOUBLE: return OP_LE;
+    case OP_GT_INT: case OP_GT_DOUBLE: return OP_GT;
+    case OP_GE_INT: case OP_GE_DOUBLE: return OP_GE;
+    default: return op;
+  }
+}
+
+
+bool is_jump(OpCode op)
+{
+  switch (op) {
+    case OP_JUMP: case OP_JUMP_IF_FALSE: case OP_JUMP_IF_FALSE_KEEP:
+    case OP_JUMP_IF_TRUE_KEEP: case OP_FOR_ENTER: case OP_FOR_NEXT:
+    case OP_CMP_JUMP_INT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+int CodeObject::emit(OpCode op, int arg, int line, int column, int arg2)
+{
+  instrs.push_back(Instr{op, arg, arg2});
+  lines.push_back(line);
+  columns.push_back(column);
+  return instrs.size() - 1;
+}
+
+
+int CodeObject::add_const(const DataObject& val)
+{
+  consts.push_back(val);
+  return consts.size() - 1;
+}
+
+
+#endif
@@ -0,0 +1,551 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: compiler.h
+// DATE: 10/17/2026
+// DESC: Compiles a type-checked MyPL AST into bytecode for the VM.
+//       Variables use the frame slots assigned by the type checker, so
+//       the VM never looks up a name while running.
+//----------------------------------------------------------------------
+
+
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <algorithm>
+#include <unordered_map>
+#include "ast.h"
+#include "bytecode.h"
+#include "mypl_exception.h"
+
+
+class Compiler : public Visitor
+{
+public:
+
+  // compile into the given (empty) program
+  Compiler(Bytecode& program);
+
+  // top-level
+  void visit(Program& node);
+  void visit(FunDecl& node);
+  void visit(TypeDecl& node);
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+  void visit(PointerType& node);
+  void visit(PointerValue& node);
+
+private:
+
+  // the program being built
+  Bytecode& program;
+
+  // the code object currently being compiled
+  CodeObject* code = nullptr;
+
+  // function declarations (for parameter passing modes)
+  std::unordered_map<std::string,FunDecl*> fun_decls;
+
+  // user-defined type name to type index
+  std::unordered_map<std::string,int> type_ids;
+
+  // helpers
+  void error(const std::string& msg, const Token& token);
+  int emit(OpCode op, int arg, const Token& token);
+  int emit(OpCode op, int arg, int arg2, const Token& token);
+  void patch(int at);
+  void stmts(Span<Stmt*>& stmt_list);
+  void begin_code(int id, int frame_size);
+  int new_slot();
+  int field_site(int type, int offset);
+  void reference(Expr& expr);
+  OpCode untyped_op(Expr& node);
+};
+
+
+Compiler::Compiler(Bytecode& program)
+  : program(program)
+{
+}
+
+
+void Compiler::error(const std::string& msg, const Token& token)
+{
+  throw MyPLException(RUNTIME, msg, token.line(), token.column());
+}
+
+
+int Compiler::emit(OpCode op, int arg, const Token& token)
+{
+  return code->emit(op, arg, token.line(), token.column());
+}
+
+
+int Compiler::emit(OpCode op, int arg, int arg2, const Token& token)
+{
+  return code->emit(op, arg, token.line(), token.column(), arg2);
+}
+
+
+// point the jump at the given index to the next instruction
+void Compiler::patch(int at)
+{
+  code->instrs[at].arg = code->instrs.size();
+}
+
+
+// compile a statement block, discarding the value of call statements
+void Compiler::stmts(Span<Stmt*>& stmt_list)
+{
+  for (Stmt* s : stmt_list) {
+    s->accept(*this);
+    if (dynamic_cast<CallExpr*>(s))
+      code->emit(OP_POP, 0, 0, 0);
+  }
+}
+
+
+void Compiler::begin_code(int id, int frame_size)
+{
+  code = &program.functions[id];
+  code->num_locals = frame_size;
+}
+
+
+// a hidden slot (after the type checker's slots) for compiler temps
+int Compiler::new_slot()
+{
+  return code->num_locals++;
+}
+
+
+// a new field access site (with its own inline cache in the VM) for
+// a field of the given type
+int Compiler::field_site(int type, int offset)
+{
+  program.field_sites.push_back(FieldRef{type, offset});
+  return program.field_sites.size() - 1;
+}
+
+
+// push a reference for a pointer variable or pointer parameter: &x
+// and ~p refer to existing slots, anything else is stored in a fresh
+// hidden slot first
+void Compiler::reference(Expr& expr)
+{
+  SimpleTerm* term = dynamic_cast<SimpleTerm*>(expr.first);
+  if (!expr.negated and !expr.op and term) {
+    if (PointerValue* v = dynamic_cast<PointerValue*>(term->rvalue)) {
+      emit(OP_ADDR, v->slot, v->pointer);
+      return;
+    }
+    if (PointerType* p = dynamic_cast<PointerType*>(term->rvalue)) {
+      emit(OP_LOAD, p->slot, p->pointer);
+      return;
+    }
+  }
+  expr.accept(*this);
+  int slot = new_slot();
+  emit(OP_STORE, slot, expr.first_token());
+  emit(OP_ADDR, slot, expr.first_token());
+}
+
+
+//----------------------------------------------------------------------
+// top-level
+//----------------------------------------------------------------------
+
+void Compiler::visit(Program& node)
+{
+  // assign code objects up front so calls can refer to any function
+  for (Decl* d : node.decls) {
+    CodeObject obj;
+    if (FunDecl* f = dynamic_cast<FunDecl*>(d)) {
+      obj.name = f->id.lexeme();
+      obj.num_params = f->params.size();
+      program.function_ids[obj.name] = program.functions.size();
+      fun_decls[obj.name] = f;
+    }
+    else if (TypeDecl* t = dynamic_cast<TypeDecl*>(d)) {
+      obj.name = t->id.lexeme();
+      obj.num_params = 1;
+      obj.is_init = true;
+      type_ids[obj.name] = program.type_inits.size();
+      program.type_inits.push_back(program.functions.size());
+      Shape shape;
+      shape.type_name = obj.name;
+      for (VarDeclStmt* v : t->vdecls)
+        shape.fields.push_back(v->id.lexeme());
+      program.shapes.push_back(shape);
+    }
+    program.functions.push_back(obj);
+  }
+  // field paths use the type checker's sites (so its numbering), and
+  // the type initializers add theirs after them
+  for (const FieldSite& site : node.field_sites)
+    field_site(type_ids[Interner::name(site.type)], site.offset);
+  for (Decl* d : node.decls)
+    d->accept(*this);
+  program.main_id = program.function_ids["main"];
+}
+
+
+void Compiler::visit(FunDecl& node)
+{
+  begin_code(program.function_ids[node.id.lexeme()], node.frame_size);
+  stmts(node.stmts);
+  // functions without a return statement return nil
+  emit(OP_NIL, 0, node.id);
+  emit(OP_RET, 0, node.id);
+}
+
+
+// the type initializer takes the new object as its one argument (moved
+// out of slot 0 into a hidden slot, since the field variables start at
+// slot 0), evaluates each field (later fields may refer to earlier ones),
+// and returns the object
+void Compiler::visit(TypeDecl& node)
+{
+  int type = type_ids[node.id.lexeme()];
+  begin_code(program.type_inits[type], std::max(node.frame_size, 1));
+  int obj = new_slot();
+  emit(OP_LOAD, 0, node.id);
+  emit(OP_STORE, obj, node.id);
+  int offset = 0;
+  for (VarDeclStmt* v : node.vdecls) {
+    v->accept(*this);
+    emit(OP_LOAD, v->slot, v->id);
+    emit(OP_LOAD, obj, v->id);
+    emit(OP_SET_FIELD, field_site(type, offset++), v->id);
+  }
+  emit(OP_LOAD, obj, node.id);
+  emit(OP_RET, 0, node.id);
+}
+
+
+//----------------------------------------------------------------------
+// statements
+//----------------------------------------------------------------------
+
+void Compiler::visit(VarDeclStmt& node)
+{
+  if (node.id.lexeme()[0] == '~')
+    reference(*node.expr);
+  else
+    node.expr->accept(*this);
+  emit(OP_STORE, node.slot, node.id);
+}
+
+
+void Compiler::visit(AssignStmt& node)
+{
+  // rhs first (matching the tree walker), then the object path
+  node.expr->accept(*this);
+  Token first = node.lvalue_list.front();
+  int slot = node.slot;
+  bool pointer = first.type() == POINTER_TYPE;
+  if (node.lvalue_list.size() == 1) {
+    emit(pointer ? OP_STORE_REF : OP_STORE, slot, first);
+    return;
+  }
+  emit(pointer ? OP_LOAD_REF : OP_LOAD, slot, first);
+  auto it = std::next(node.lvalue_list.begin());
+  int site = node.site;
+  for (; it + 1 != node.lvalue_list.end(); ++it, ++site)
+    emit(OP_GET_FIELD, site, *it);
+  emit(OP_SET_FIELD, site, *it);
+}
+
+
+void Compiler::visit(ReturnStmt& node)
+{
+  node.expr->accept(*this);
+  emit(OP_RET, 0, node.expr->first_token());
+}
+
+
+void Compiler::visit(IfStmt& node)
+{
+  std::vector<int> end_jumps;
+  std::vector<BasicIf*> parts(1, node.if_part);
+  parts.insert(parts.end(), node.else_ifs.begin(), node.else_ifs.end());
+  for (BasicIf* part : parts) {
+    Token tok = part->expr->first_token();
+    part->expr->accept(*this);
+    int skip = emit(OP_JUMP_IF_FALSE, 0, tok);
+    stmts(part->stmts);
+    end_jumps.push_back(emit(OP_JUMP, 0, tok));
+    patch(skip);
+  }
+  stmts(node.body_stmts);
+  for (int at : end_jumps)
+    patch(at);
+}
+
+
+void Compiler::visit(WhileStmt& node)
+{
+  Token tok = node.expr->first_token();
+  int top = code->instrs.size();
+  node.expr->accept(*this);
+  int done = emit(OP_JUMP_IF_FALSE, 0, tok);
+  stmts(node.stmts);
+  emit(OP_JUMP, top, tok);
+  patch(done);
+}
+
+
+// the loop variable runs from start to end inclusive, with the end
+// bound evaluated once into a hidden slot
+void Compiler::visit(ForStmt& node)
+{
+  Token tok = node.var_id;
+  node.start->accept(*this);
+  int var = node.slot;
+  emit(OP_STORE, var, tok);
+  node.end->accept(*this);
+  // a counting loop keeps its bound on the stack, and one instruction
+  // steps, tests, and jumps back per iteration
+  if (node.counted) {
+    int enter = emit(OP_FOR_ENTER, 0, var, tok);
+    int body = code->instrs.size();
+    stmts(node.stmts);
+    emit(OP_FOR_NEXT, body, var, tok);
+    patch(enter);
+    emit(OP_POP, 0, tok);
+    return;
+  }
+  int bound = new_slot();
+  emit(OP_STORE, bound, tok);
+  int top = code->instrs.size();
+  emit(OP_LOAD, var, tok);
+  emit(OP_LOAD, bound, tok);
+  emit(OP_LE, 0, tok);
+  int done = emit(OP_JUMP_IF_FALSE, 0, tok);
+  stmts(node.stmts);
+  emit(OP_LOAD, var, tok);
+  emit(OP_CONST, code->add_const(DataObject(1)), tok);
+  emit(OP_ADD, 0, tok);
+  emit(OP_STORE, var, tok);
+  emit(OP_JUMP, top, tok);
+  patch(done);
+}
+
+
+//----------------------------------------------------------------------
+// expressions
+//----------------------------------------------------------------------
+
+void Compiler::visit(Expr& node)
+{
+  node.first->accept(*this);
+  if (node.negated) {
+    emit(OP_NOT, 0, node.first_token());
+    return;
+  }
+  if (!node.op)
+    return;
+  // and/or skip the rhs when the lhs decides the result (a nil lhs
+  // falls through to the operator's error)
+  int skip = -1;
+  if (node.bin_op == BinOp::AND)
+    skip = emit(OP_JUMP_IF_FALSE_KEEP, 0, *node.op);
+  else if (node.bin_op == BinOp::OR)
+    skip = emit(OP_JUMP_IF_TRUE_KEEP, 0, *node.op);
+  node.rest->accept(*this);
+  OpCode op;
+  //operands of known types get a specialized instruction
+  switch (node.kernel) {
+    case Kernel::INT_ADD: op = OP_ADD_INT; break;
+    case Kernel::INT_SUB: op = OP_SUB_INT; break;
+    case Kernel::INT_MUL: op = OP_MUL_INT; break;
+    case Kernel::INT_DIV: op = OP_DIV_INT; break;
+    case Kernel::INT_MOD: op = OP_MOD_INT; break;
+    case Kernel::INT_EQ: op = OP_EQ_INT; break;
+    case Kernel::INT_NE: op = OP_NE_INT; break;
+    case Kernel::INT_LT: op = OP_LT_INT; break;
+    case Kernel::INT_LE: op = OP_LE_INT; break;
+    case Kernel::INT_GT: op = OP_GT_INT; break;
+    case Kernel::INT_GE: op = OP_GE_INT; break;
+    case Kernel::DOUBLE_ADD: op = OP_ADD_DOUBLE; break;
+    case Kernel::DOUBLE_SUB: op = OP_SUB_DOUBLE; break;
+    case Kernel::DOUBLE_MUL: op = OP_MUL_DOUBLE; break;
+    case Kernel::DOUBLE_DIV: op = OP_DIV_DOUBLE; break;
+    case Kernel::DOUBLE_LT: op = OP_LT_DOUBLE; break;
+    case Kernel::DOUBLE_LE: op = OP_LE_DOUBLE; break;
+    case Kernel::DOUBLE_GT: op = OP_GT_DOUBLE; break;
+    case Kernel::DOUBLE_GE: op = OP_GE_DOUBLE; break;
+    case Kernel::STRING_CONCAT: op = OP_CONCAT; break;
+    case Kernel::GENERIC: op = untyped_op(node); break;
+  }
+  emit(op, 0, node.first_token());
+  if (skip >= 0)
+    patch(skip);
+}
+
+
+OpCode Compiler::untyped_op(Expr& node)
+{
+  OpCode op = OP_ADD;
+  switch (node.bin_op) {
+    case BinOp::ADD: op = OP_ADD; break;
+    case BinOp::SUB: op = OP_SUB; break;
+    case BinOp::MUL: op = OP_MUL; break;
+    case BinOp::DIV: op = OP_DIV; break;
+    case BinOp::MOD: op = OP_MOD; break;
+    case BinOp::AND: op = OP_AND; break;
+    case BinOp::OR: op = OP_OR; break;
+    case BinOp::EQ: op = OP_EQ; break;
+    case BinOp::NE: op = OP_NE; break;
+    case BinOp::LT: op = OP_LT; break;
+    case BinOp::LE: op = OP_LE; break;
+    case BinOp::GT: op = OP_GT; break;
+    case BinOp::GE: op = OP_GE; break;
+    default: error("unexpected operator", *node.op);
+  }
+  return op;
+}
+
+
+void Compiler::visit(SimpleTerm& node)
+{
+  node.rvalue->accept(*this);
+}
+
+
+void Compiler::visit(ComplexTerm& node)
+{
+  node.expr->accept(*this);
+}
+
+
+//----------------------------------------------------------------------
+// rvalues
+//----------------------------------------------------------------------
+
+void Compiler::visit(SimpleRValue& node)
+{
+  if (node.value.type() == NIL) {
+    emit(OP_NIL, 0, node.value);
+    return;
+  }
+  if (node.decoded) {
+    emit(OP_CONST, code->add_const(node.val), node.value);
+    return;
+  }
+  DataObject val;
+  const std::string& lexeme = node.value.lexeme();
+  if (node.value.type() == CHAR_VAL)
+    val.set(lexeme.at(0));
+  else if (node.value.type() == STRING_VAL)
+    val.set(lexeme);
+  else if (node.value.type() == BOOL_VAL)
+    val.set(lexeme == "true");
+  else if (node.value.type() == INT_VAL) {
+    try {
+      val.set(std::stoi(lexeme));
+    }
+    catch (const std::out_of_range& e) {
+      error("int out of range", node.value);
+    }
+  }
+  else if (node.value.type() == DOUBLE_VAL) {
+    try {
+      val.set(std::stod(lexeme));
+    }
+    catch (const std::out_of_range& e) {
+      error("double out of range", node.value);
+    }
+  }
+  emit(OP_CONST, code->add_const(val), node.value);
+}
+
+
+void Compiler::visit(NewRValue& node)
+{
+  int type_id = type_ids[node.type_id.lexeme()];
+  emit(OP_ALLOC, type_id, node.type_id);
+  emit(OP_CALL, program.type_inits[type_id], node.type_id);
+}
+
+
+void Compiler::visit(CallExpr& node)
+{
+  Token id = node.function_id;
+  std::string fun_name = id.lexeme();
+  OpCode op = OP_CALL;
+  if (fun_name == "print") op = OP_PRINT;
+  else if (fun_name == "stoi") op = OP_STOI;
+  else if (fun_name == "stod") op = OP_STOD;
+  else if (fun_name == "itos") op = OP_ITOS;
+  else if (fun_name == "dtos") op = OP_DTOS;
+  else if (fun_name == "get") op = OP_GET;
+  else if (fun_name == "length") op = OP_LENGTH;
+  else if (fun_name == "read") op = OP_READ;
+  if (op != OP_CALL) {
+    for (Expr* e : node.arg_list)
+      e->accept(*this);
+    emit(op, 0, id);
+    return;
+  }
+  // pointer parameters are passed by reference
+  auto param = fun_decls[fun_name]->params.begin();
+  for (Expr* e : node.arg_list) {
+    if (param->id.type() == POINTER_TYPE)
+      reference(*e);
+    else
+      e->accept(*this);
+    ++param;
+  }
+  emit(node.tail ? OP_TAIL_CALL : OP_CALL, program.function_ids[fun_name],
+       id);
+}
+
+
+void Compiler::visit(IDRValue& node)
+{
+  auto it = node.path.begin();
+  emit(OP_LOAD, node.slot, *it);
+  int site = node.site;
+  for (++it; it != node.path.end(); ++it, ++site)
+    emit(OP_GET_FIELD, site, *it);
+}
+
+
+void Compiler::visit(NegatedRValue& node)
+{
+  node.expr->accept(*this);
+  emit(OP_NEG, 0, node.first_token());
+}
+
+
+// ~p used as a value reads through the reference
+void Compiler::visit(PointerType& node)
+{
+  emit(OP_LOAD_REF, node.slot, node.pointer);
+}
+
+
+// &x used as a value (outside a pointer declaration or argument) is
+// the value of x
+void Compiler::visit(PointerValue& node)
+{
+  emit(OP_LOAD, node.slot, node.pointer);
+}
+
+
+#endif
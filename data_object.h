@@ -5,6 +5,8 @@
 // Desc: For representing MyPL basic data values during
 //       interpretation. A DataType is essentially a container for a
 //       primitive value that can be set (modified) and retrieved.
+//       Scalars (int, double, char, bool, oid, ref) are stored inline
+//       in a tagged union; only strings are allocated out of line.
 //----------------------------------------------------------------------
 
 
@@ -12,6 +14,7 @@
 #define DATA_OBJECT_H
 
 #include <string>
+#include <utility>
 
 
 
@@ -19,7 +22,9 @@ class DataObject
 {
 public:
 
-  enum DataType {INTEGER, DOUBLE, STRING, CHAR, BOOL, OID, NIL};
+  // REF is a reference to a variable: the absolute index of its slot
+  // in the running program's locals (not a heap oid)
+  enum DataType {INTEGER, DOUBLE, STRING, CHAR, BOOL, OID, REF, NIL};
 
   // construction
   DataObject();
@@ -35,14 +40,19 @@ public:
   // copying
   DataObject(const DataObject& rhs);
   DataObject& operator=(const DataObject& rhs);
+  // moving (steals the string of rhs, leaving it nil)
+  DataObject(DataObject&& rhs) noexcept;
+  DataObject& operator=(DataObject&& rhs) noexcept;
   // set/update
   void set(int val);
   void set(double val);
   void set(const char* val);
   void set(const std::string& val);
+  void set(std::string&& val);
   void set(char val);
   void set(bool val);
   void set(size_t val);
+  void set_ref(size_t addr);
   void set_nil(); 
   // get and check type
   DataType type() const;
@@ -53,6 +63,7 @@ public:
   bool is_char() const;
   bool is_bool() const;
   bool is_oid() const;
+  bool is_ref() const;
   // get the value
   bool value(int& val) const;
   bool value(double& val) const;
@@ -60,12 +71,27 @@ public:
   bool value(char& val) const;
   bool value(bool& val) const;
   bool value(size_t& val) const;  
+  bool ref(size_t& addr) const;
+  // append rhs's string to this string in place (false, and nothing
+  // done, unless both are strings)
+  bool append(const DataObject& rhs);
+  // bytes allocated out of line (a string's buffer, else 0)
+  size_t bytes() const;
   // get a string representation
   std::string to_string() const;
  private:
-  void* value_ptr = nullptr;
+  union {
+    int int_val;
+    double double_val;
+    char char_val;
+    bool bool_val;
+    size_t oid_val;
+    size_t ref_val;
+    std::string* str_val;
+  };
   DataType value_type = DataType::NIL;
   void delete_obj();
+  void copy_scalar(const DataObject& rhs);
 };
 
 
@@ -76,42 +102,41 @@ public:
 
 DataObject::DataObject()
 {
-  set_nil();
 }
 
 DataObject::DataObject(int val)
+  : int_val(val), value_type(DataType::INTEGER)
 {
-  set(val);
 }
 
 DataObject::DataObject(double val)
+  : double_val(val), value_type(DataType::DOUBLE)
 {
-  set(val);
 }
 
 DataObject::DataObject(const char* val)
+  : str_val(new std::string(val)), value_type(DataType::STRING)
 {
-  set(std::string(val));
 }
 
 DataObject::DataObject(const std::string& val)
+  : str_val(new std::string(val)), value_type(DataType::STRING)
 {
-  set(val);
 }
 
 DataObject::DataObject(char val)
+  : char_val(val), value_type(DataType::CHAR)
 {
-  set(val);
 }
 
 DataObject::DataObject(bool val)
+  : bool_val(val), value_type(DataType::BOOL)
 {
-  set(val);
 }
 
 DataObject::DataObject(size_t val)
+  : oid_val(val), value_type(DataType::OID)
 {
-  set(val);
 }
 
 
@@ -120,18 +145,23 @@ DataObject::DataObject(size_t val)
 //----------------------------------------------------------------------
 void DataObject::delete_obj()
 {
-  if (value_type == DataType::INTEGER)
-    delete (int*)value_ptr;
-  else if (value_type == DataType::DOUBLE)
-    delete (double*)value_ptr;
-  else if (value_type == DataType::STRING)
-    delete (std::string*)value_ptr;
-  else if (value_type == DataType::CHAR)
-    delete (char*)value_ptr;
-  else if (value_type == DataType::BOOL)
-    delete (bool*)value_ptr;
-  else if (value_type == DataType::OID)
-    delete (size_t*)value_ptr;
+  if (value_type == DataType::STRING)
+    delete str_val;
+}
+
+// copy a non-string payload (the caller has released any string)
+void DataObject::copy_scalar(const DataObject& rhs)
+{
+  switch (rhs.value_type) {
+    case DataType::INTEGER: int_val = rhs.int_val; break;
+    case DataType::DOUBLE: double_val = rhs.double_val; break;
+    case DataType::CHAR: char_val = rhs.char_val; break;
+    case DataType::BOOL: bool_val = rhs.bool_val; break;
+    case DataType::OID: oid_val = rhs.oid_val; break;
+    case DataType::REF: ref_val = rhs.ref_val; break;
+    default: break;
+  }
+  value_type = rhs.value_type;
 }
 
 DataObject::~DataObject()
@@ -153,39 +183,32 @@ DataObject& DataObject::operator=(const DataObject& rhs)
 {
   if (this == &rhs)
     return *this;
-  if (rhs.is_integer()) {
-    int v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_double()) {
-    double v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_string()) {
-    std::string v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_char()) {
-    char v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_bool()) {
-    bool v;
-    rhs.value(v);
-    set(v);
-  }
-  else if (rhs.is_oid()) {
-    size_t v;
-    rhs.value(v);
-    set(v);
+  if (rhs.is_string()) {
+    set(*rhs.str_val);
+    return *this;
   }
-  else if (rhs.is_nil()) {
-    set_nil();
+  delete_obj();
+  copy_scalar(rhs);
+  return *this;
+}
+
+DataObject::DataObject(DataObject&& rhs) noexcept
+{
+  *this = std::move(rhs);
+}
+
+DataObject& DataObject::operator=(DataObject&& rhs) noexcept
+{
+  if (this == &rhs)
+    return *this;
+  delete_obj();
+  if (rhs.is_string()) {
+    str_val = rhs.str_val;
+    value_type = DataType::STRING;
   }
+  else
+    copy_scalar(rhs);
+  rhs.value_type = DataType::NIL;
   return *this;
 }
 
@@ -197,63 +220,74 @@ DataObject& DataObject::operator=(const DataObject& rhs)
 void DataObject::set(int val)
 {
   delete_obj();
-  value_ptr = new int;
-  *((int*)value_ptr) = val;
+  int_val = val;
   value_type = DataType::INTEGER;
 }
 
 void DataObject::set(double val)
 {
   delete_obj();
-  value_ptr = new double;
-  *((double*)value_ptr) = val;
+  double_val = val;
   value_type = DataType::DOUBLE;
 }
 
 void DataObject::set(const char* val)
 {
-  delete_obj();
-  value_ptr = new std::string;
-  *((std::string*)value_ptr) = val;
-  value_type = DataType::STRING;
+  set(std::string(val));
 }
 
 void DataObject::set(const std::string& val)
 {
-  delete_obj();
-  value_ptr = new std::string;
-  *((std::string*)value_ptr) = val;
+  // reuse the existing string buffer when already a string
+  if (value_type == DataType::STRING) {
+    *str_val = val;
+    return;
+  }
+  str_val = new std::string(val);
+  value_type = DataType::STRING;
+}
+
+void DataObject::set(std::string&& val)
+{
+  if (value_type == DataType::STRING) {
+    *str_val = std::move(val);
+    return;
+  }
+  str_val = new std::string(std::move(val));
   value_type = DataType::STRING;
 }
 
 void DataObject::set(char val)
 {
   delete_obj();
-  value_ptr = new char;
-  *((char*)value_ptr) = val;
+  char_val = val;
   value_type = DataType::CHAR;
 }
 
 void DataObject::set(bool val)
 {
   delete_obj();
-  value_ptr = new bool;
-  *((bool*)value_ptr) = val;
+  bool_val = val;
   value_type = DataType::BOOL;
 }
 
 void DataObject::set(size_t val)
 {
   delete_obj();
-  value_ptr = new size_t;
-  *((size_t*)value_ptr) = val;
+  oid_val = val;
   value_type = DataType::OID;
 }
 
+void DataObject::set_ref(size_t addr)
+{
+  delete_obj();
+  ref_val = addr;
+  value_type = DataType::REF;
+}
+
 void DataObject::set_nil() 
 {
   delete_obj();
-  value_ptr = nullptr;
   value_type = DataType::NIL;
 }
 
@@ -302,6 +336,11 @@ bool DataObject::is_oid() const
   return type() == DataType::OID;
 }
 
+bool DataObject::is_ref() const
+{
+  return type() == DataType::REF;
+}
+
 
 //----------------------------------------------------------------------
 // GET THE VALUE
@@ -309,52 +348,73 @@ bool DataObject::is_oid() const
 
 bool DataObject::value(int& val) const
 {
-  if (value_type != DataType::INTEGER or !value_ptr)
+  if (value_type != DataType::INTEGER)
     return false;
-  val = *((int*)value_ptr);
+  val = int_val;
   return true;
 }
 
 bool DataObject::value(double& val) const
 {
-  if (value_type != DataType::DOUBLE or !value_ptr)
+  if (value_type != DataType::DOUBLE)
     return false;
-  val = *((double*)value_ptr);
+  val = double_val;
   return true;
 }
 
 bool DataObject::value(std::string& val) const
 {
-  if (value_type != DataType::STRING or !value_ptr)
+  if (value_type != DataType::STRING)
     return false;
-  val = *((std::string*)value_ptr);
+  val = *str_val;
   return true;
 }
 
 bool DataObject::value(char& val) const
 {
-  if (value_type != DataType::CHAR or !value_ptr)
+  if (value_type != DataType::CHAR)
     return false;
-  val = *((char*)value_ptr);
+  val = char_val;
   return true;
 }
 
 bool DataObject::value(bool& val) const
 {
-  if (value_type != DataType::BOOL or !value_ptr)
+  if (value_type != DataType::BOOL)
     return false;
-  val = *((bool*)value_ptr);
+  val = bool_val;
   return true;
 }
 
 bool DataObject::value(size_t& val) const  
 {
-  if (value_type != DataType::OID or !value_ptr)
+  if (value_type != DataType::OID)
     return false;
-  val = *((size_t*)value_ptr);
+  val = oid_val;
   return true;
 }
 
+bool DataObject::ref(size_t& addr) const
+{
+  if (value_type != DataType::REF)
+    return false;
+  addr = ref_val;
+  return true;
+}
+
+bool DataObject::append(const DataObject& rhs)
+{
+  if (value_type != DataType::STRING or rhs.value_type != DataType::STRING)
+    return false;
+  *str_val += *rhs.str_val;
+  return true;
+}
+
+size_t DataObject::bytes() const
+{
+  return value_type == DataType::STRING ? str_val->capacity() : 0;
+}
+
 
 //----------------------------------------------------------------------
 // GET A STRING REPRESENTATION
@@ -362,20 +422,19 @@ bool DataObject::value(size_t& val) const
 
 std::string DataObject::to_string() const
 {
-  if (!value_ptr or value_type == DataType::NIL)
-    return "";
-  else if (value_type == DataType::INTEGER)
-    return std::to_string(*((int*)value_ptr));
+  if (value_type == DataType::INTEGER)
+    return std::to_string(int_val);
   else if (value_type == DataType::DOUBLE)
-    return std::to_string(*((double*)value_ptr));
+    return std::to_string(double_val);
   else if (value_type == DataType::STRING)
-    return *((std::string*)value_ptr);
+    return *str_val;
   else if (value_type == DataType::CHAR)
-    return std::to_string(*((char*)value_ptr));
+    return std::to_string(char_val);
   else if (value_type == DataType::BOOL)
-    return std::to_string(*((bool*)value_ptr));
+    return std::to_string(bool_val);
   else if (value_type == DataType::OID)
-    return std::to_string(*((size_t*)value_ptr));
+    return std::to_string(oid_val);
+  return "";
 }
 
 
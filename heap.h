@@ -4,54 +4,139 @@
 // Date: Spring 2021
 // Desc: Basic Heap implementation for the MyPL Interpreter. The Heap
 //       is used to store objects of user-defined types. Each object
-//       has a unique object id (OID) and a collection of key-value
-//       pairs. The keys denote user-defined type variable names and
-//       the values denote the corresponding variable values. Each
-//       value is represented as a DataObject. The key-value pairs are
-//       represented as HeapObjects.
+//       has a unique object id (OID) and a fixed array of field
+//       values (DataObjects), represented as a HeapObject. The field
+//       names are kept once per type in a shared Shape, and a field
+//       is accessed by its offset (resolved by the type checker),
+//       through a FieldCache per access site that guards the offset
+//       with the type's shape. Unreachable objects are freed by a
+//       mark-and-sweep collector once the (estimated) heap size
+//       passes a configurable threshold.
 //----------------------------------------------------------------------
 
 #ifndef HEAP_H
 #define HEAP_H
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <ostream>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include "data_object.h"
 
 
-class HeapObject
+// the field layout shared by every object of a user-defined type
+class Shape
+{
+public:
+  std::string type_name;            // the user-defined type
+  std::vector<std::string> fields;  // field names (offset = index)
+};
+
+
+// inline cache hits and misses over every field access site
+struct FieldCacheStats
+{
+  size_t hits = 0;
+  size_t misses = 0;
+};
+
+
+// a monomorphic inline cache for one field access site, seeded with
+// the shape of the type the site's field belongs to and the field's
+// offset in it (both known from the type checker)
+class FieldCache
 {
 public:
 
+  // an empty cache (every access misses)
+  FieldCache() = default;
+
   //----------------------------------------------------------------------
-  // Add or update a given name with the given data object.
+  // Create a cache for a field of the given shape.
   // Inputs:
-  //   att -- the attribute (variable) name
-  //   obj -- the attribute (variable) value
+  //   shape -- the field's type layout (must outlive the cache)
+  //   offset -- the field offset (from the type checker)
   //----------------------------------------------------------------------
-  void set_att(const std::string& att, const DataObject& obj);
+  FieldCache(const Shape* shape, int offset);
 
   //----------------------------------------------------------------------
-  // Check if the attribute exists in the heap object
+  // Get the offset of the site's field in an object of the given shape.
+  // A hit is a shape compare. Static types mean a site only ever sees
+  // the type it was seeded with, so a miss is a bug (and asserted).
   // Inputs:
-  //   att -- the attribute (variable) to check
+  //   shape -- the accessed object's shape
+  //   stats -- the hit or miss is counted here
   // Returns:
-  //   true if the attribute has been added, false otherwise
+  //   the field offset
   //----------------------------------------------------------------------
-  bool has_att(const std::string& att) const;
+  int offset(const Shape* shape, FieldCacheStats& stats) const;
+
+private:
+  const Shape* shape = nullptr;
+  int cached = -1;
+};
+
+
+class HeapObject
+{
+public:
+
+  // an object with no fields
+  HeapObject() = default;
+
+  //----------------------------------------------------------------------
+  // Create an object of the given shape with every field nil.
+  // Inputs:
+  //   shape -- the object's type layout (must outlive the object)
+  //----------------------------------------------------------------------
+  HeapObject(const Shape* shape);
 
   //----------------------------------------------------------------------
-  // Get the value of the given attribute
+  // Set the field at the given offset
   // Inputs:
-  //   att -- the attribute to get the value of
+  //   offset -- the field offset (from the type checker)
+  //   obj -- the field value
+  //----------------------------------------------------------------------
+  void set_field(int offset, const DataObject& obj);
+  void set_field(int offset, DataObject&& obj);
+
+  //----------------------------------------------------------------------
+  // Get the field at the given offset
+  // Inputs:
+  //   offset -- the field offset (from the type checker)
+  // Returns:
+  //   the field value
+  //----------------------------------------------------------------------
+  const DataObject& get_field(int offset) const;
+
+  //----------------------------------------------------------------------
+  // Get the object's layout
+  // Returns:
+  //   the shape shared by all objects of the type (or nullptr)
+  //----------------------------------------------------------------------
+  const Shape* get_shape() const;
+
+  //----------------------------------------------------------------------
+  // Add the oids referred to by the object's fields
   // Outputs:
-  //   obj -- the value of the object
+  //   oids -- the oids are appended
+  //----------------------------------------------------------------------
+  void get_refs(std::vector<size_t>& oids) const;
+
+  //----------------------------------------------------------------------
+  // Estimate the memory used by the object
   // Returns:
-  //   true if the heap object has the given attribute defined
+  //   the approximate size of the object in bytes
   //----------------------------------------------------------------------
-  bool get_val(const std::string& att, DataObject& val);  
+  size_t bytes() const;
 
 private:
-  std::unordered_map<std::string,DataObject> attribute_values;
+  const Shape* shape = nullptr;
+  std::vector<DataObject> fields;
 };
 
 
@@ -63,9 +148,9 @@ public:
   // Add or update the oid with the given heap object.
   // Inputs:
   //   oid -- the oid to add or update
-  //   obj -- the value of the oid
+  //   obj -- the value of the oid (moved into the heap)
   //----------------------------------------------------------------------
-  void set_obj(size_t oid, const HeapObject& obj);
+  void set_obj(size_t oid, HeapObject obj);
 
   //----------------------------------------------------------------------
   // Check if the oid is in the heap.
@@ -77,41 +162,166 @@ public:
   bool has_obj(size_t oid) const;
 
   //----------------------------------------------------------------------
-  // Get the user-defined type object associated with given oid.
+  // Get the user-defined type object associated with given oid. The
+  // object is not copied: reads and writes go straight to the stored
+  // object. The handle stays valid until the next sweep().
   // Inputs:
   //   oid -- the oid to look up
-  // Outputs:
-  //   obj -- the heap object associated with the oid
   // Returns:
-  //   true if the oid is present in the heap, and false otherwise
+  //   the heap object, or nullptr if the oid is not in the heap
+  //----------------------------------------------------------------------
+  HeapObject* get_obj(size_t oid);
+
+  //----------------------------------------------------------------------
+  // Set a field of an object in the heap, counting the change in the
+  // size of the field's value (e.g., a longer string) toward the heap
+  // size, so stores can trigger a collection as allocations do.
+  // Inputs:
+  //   obj -- the object (a handle from get_obj())
+  //   offset -- the field offset
+  //   val -- the field value
+  //----------------------------------------------------------------------
+  void set_field(HeapObject& obj, int offset, const DataObject& val);
+  void set_field(HeapObject& obj, int offset, DataObject&& val);
+
+  //----------------------------------------------------------------------
+  // Check if the heap has grown past the collection threshold. The
+  // caller should then mark its roots and call sweep().
+  // Returns:
+  //   true if a collection should be run before the next allocation
+  //----------------------------------------------------------------------
+  bool needs_collection() const;
+
   //----------------------------------------------------------------------
-  bool get_obj(size_t oid, HeapObject& obj) const;
+  // Mark the object (if any) the value refers to, along with every
+  // object reachable from it. Values that are not oids are ignored.
+  // Inputs:
+  //   root -- a value that is live in the program
+  //----------------------------------------------------------------------
+  void mark(const DataObject& root);
+
+  //----------------------------------------------------------------------
+  // Free every object not marked since the last sweep, record the
+  // collection in the statistics, and set the next threshold.
+  //----------------------------------------------------------------------
+  void sweep();
+
+  //----------------------------------------------------------------------
+  // Set the heap size (in bytes) that triggers the first collection.
+  // After a collection the threshold is twice the surviving size (but
+  // never below this value), so memory stays bounded by the live data.
+  // Inputs:
+  //   bytes -- the minimum collection threshold
+  //----------------------------------------------------------------------
+  void set_threshold(size_t bytes);
+
+  //----------------------------------------------------------------------
+  // Write the collector statistics.
+  // Inputs:
+  //   out -- the stream to write to
+  //----------------------------------------------------------------------
+  void print_stats(std::ostream& out) const;
 
 private:
-  std::unordered_map<size_t, HeapObject> heap_objs;
+
+  // an object along with its collector bookkeeping
+  struct HeapEntry {
+    HeapObject obj;
+    bool marked = false;
+  };
+
+  // (map nodes never move, so object handles are stable)
+  std::unordered_map<size_t, HeapEntry> heap_objs;
+
+  // estimated size of all objects
+  size_t heap_bytes = 0;
+
+  // collection trigger
+  size_t min_threshold = 1 << 20;
+  size_t threshold = 1 << 20;
+
+  // pending marks (an explicit stack so long lists don't recurse)
+  std::vector<size_t> mark_stack;
+
+  // when the current collection started marking
+  std::chrono::steady_clock::time_point gc_start;
+  bool marking = false;
+
+  // collector statistics
+  size_t collections = 0;
+  size_t objects_freed = 0;
+  size_t bytes_freed = 0;
+  size_t peak_bytes = 0;
+  double total_pause_ms = 0.0;
+  double max_pause_ms = 0.0;
 };
 
 
+//----------------------------------------------------------------------
+// FieldCache Member Functions
+//----------------------------------------------------------------------
+
+FieldCache::FieldCache(const Shape* shape, int offset)
+  : shape(shape), cached(offset)
+{
+}
+
+int FieldCache::offset(const Shape* shape, FieldCacheStats& stats) const
+{
+  if (shape == this->shape) {
+    ++stats.hits;
+    return cached;
+  }
+  ++stats.misses;
+  assert(!"a field site reached an object of another type");
+  return cached;
+}
+
+
 //----------------------------------------------------------------------
 // HeapObject Member Functions
 //----------------------------------------------------------------------
 
-void HeapObject::set_att(const std::string& att, const DataObject& obj)
+HeapObject::HeapObject(const Shape* shape)
+  : shape(shape), fields(shape->fields.size())
+{
+}
+
+void HeapObject::set_field(int offset, const DataObject& obj)
+{
+  fields[offset] = obj;
+}
+
+void HeapObject::set_field(int offset, DataObject&& obj)
+{
+  fields[offset] = std::move(obj);
+}
+
+const DataObject& HeapObject::get_field(int offset) const
+{
+  return fields[offset];
+}
+
+const Shape* HeapObject::get_shape() const
 {
-  attribute_values[att] = obj;
+  return shape;
 }
 
-bool HeapObject::has_att(const std::string& att) const
+void HeapObject::get_refs(std::vector<size_t>& oids) const
 {
-  return attribute_values.count(att) > 0;
+  size_t oid;
+  for (const DataObject& field : fields) {
+    if (field.value(oid))
+      oids.push_back(oid);
+  }
 }
 
-bool HeapObject::get_val(const std::string& att, DataObject& val)
+size_t HeapObject::bytes() const
 {
-  if (!has_att(att))
-    return false;
-  val = attribute_values.at(att);
-  return true;
+  size_t total = sizeof(HeapObject) + fields.capacity() * sizeof(DataObject);
+  for (const DataObject& field : fields)
+    total += field.bytes();
+  return total;
 }
 
 
@@ -119,9 +329,14 @@ bool HeapObject::get_val(const std::string& att, DataObject& val)
 // Heap Member Functions
 //----------------------------------------------------------------------
 
-void Heap::set_obj(size_t oid, const HeapObject& obj)
+void Heap::set_obj(size_t oid, HeapObject obj)
 {
-  heap_objs[oid] = obj;
+  HeapEntry& entry = heap_objs[oid];
+  heap_bytes -= entry.obj.bytes();
+  heap_bytes += obj.bytes();
+  entry.obj = std::move(obj);
+  if (heap_bytes > peak_bytes)
+    peak_bytes = heap_bytes;
 }
 
 
@@ -131,12 +346,104 @@ bool Heap::has_obj(size_t oid) const
 }
 
 
-bool Heap::get_obj(size_t oid, HeapObject& obj) const
+HeapObject* Heap::get_obj(size_t oid)
+{
+  auto it = heap_objs.find(oid);
+  if (it == heap_objs.end())
+    return nullptr;
+  return &it->second.obj;
+}
+
+
+void Heap::set_field(HeapObject& obj, int offset, const DataObject& val)
+{
+  set_field(obj, offset, DataObject(val));
+}
+
+
+void Heap::set_field(HeapObject& obj, int offset, DataObject&& val)
+{
+  size_t old_bytes = obj.get_field(offset).bytes();
+  obj.set_field(offset, std::move(val));
+  heap_bytes = heap_bytes - old_bytes + obj.get_field(offset).bytes();
+  if (heap_bytes > peak_bytes)
+    peak_bytes = heap_bytes;
+}
+
+
+bool Heap::needs_collection() const
+{
+  return heap_bytes >= threshold;
+}
+
+
+
+void Heap::mark(const DataObject& root)
+{
+  if (!marking) {
+    gc_start = std::chrono::steady_clock::now();
+    marking = true;
+  }
+  size_t oid;
+  if (!root.value(oid))
+    return;
+  mark_stack.push_back(oid);
+  while (!mark_stack.empty()) {
+    auto it = heap_objs.find(mark_stack.back());
+    mark_stack.pop_back();
+    if (it == heap_objs.end() or it->second.marked)
+      continue;
+    it->second.marked = true;
+    it->second.obj.get_refs(mark_stack);
+  }
+}
+
+
+void Heap::sweep()
+{
+  if (!marking)
+    gc_start = std::chrono::steady_clock::now();
+  marking = false;
+  heap_bytes = 0;
+  for (auto it = heap_objs.begin(); it != heap_objs.end(); ) {
+    size_t bytes = it->second.obj.bytes();
+    if (it->second.marked) {
+      it->second.marked = false;
+      heap_bytes += bytes;
+      ++it;
+    }
+    else {
+      bytes_freed += bytes;
+      ++objects_freed;
+      it = heap_objs.erase(it);
+    }
+  }
+  threshold = std::max(min_threshold, 2 * heap_bytes);
+  std::chrono::duration<double,std::milli> pause =
+    std::chrono::steady_clock::now() - gc_start;
+  ++collections;
+  total_pause_ms += pause.count();
+  max_pause_ms = std::max(max_pause_ms, pause.count());
+}
+
+
+void Heap::set_threshold(size_t bytes)
+{
+  min_threshold = bytes;
+  threshold = bytes;
+}
+
+
+void Heap::print_stats(std::ostream& out) const
 {
-  if (!has_obj(oid))
-    return false;
-  obj = heap_objs.at(oid);
-  return true;
+  out << "gc collections:    " << collections << std::endl;
+  out << "gc total pause:    " << total_pause_ms << " ms" << std::endl;
+  out << "gc max pause:      " << max_pause_ms << " ms" << std::endl;
+  out << "gc objects freed:  " << objects_freed << std::endl;
+  out << "gc bytes freed:    " << bytes_freed << std::endl;
+  out << "heap live objects: " << heap_objs.size() << std::endl;
+  out << "heap live bytes:   " << heap_bytes << std::endl;
+  out << "heap peak bytes:   " << peak_bytes << std::endl;
 }
 
 
@@ -7,42 +7,193 @@
 
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
+#include <string>
 #include "token.h"
 #include "mypl_exception.h"
 #include "lexer.h"
 #include "parser.h"
 #include "ast.h"
 #include "type_checker.h"
+#include "optimizer.h"
 #include "interpreter.h"
+#include "compiler.h"
+#include "peephole.h"
+#include "vm.h"
 
 using namespace std;
 
 
+// write the profiler report to stderr, or to the file if one is given
+void write_profile(const Profiler& profiler, const string& file)
+{
+  if (file.empty()) {
+    profiler.report(cerr);
+    return;
+  }
+  ofstream out(file);
+  profiler.report(out);
+}
+
+
+// write the field inline cache hits and misses to stderr
+void write_field_stats(const FieldCacheStats& stats)
+{
+  size_t total = stats.hits + stats.misses;
+  cerr << "field cache hits:   " << stats.hits << endl;
+  cerr << "field cache misses: " << stats.misses << endl;
+  cerr << "field cache hit %:  "
+       << (total ? 100.0 * stats.hits / total : 0.0) << endl;
+}
+
+
+// parse a non-negative count given as a command-line option value
+bool parse_count(const string& text, size_t& count)
+{
+  if (text.empty() or text.find_first_not_of("0123456789") != string::npos)
+    return false;
+  try {
+    count = stoul(text);
+  }
+  catch (const out_of_range& e) {
+    return false;
+  }
+  return true;
+}
+
+
 int main(int argc, char* argv[])
 {
+  // buffer program output in cout itself (flushed per --flush)
+  ios::sync_with_stdio(false);
   // use standard input if no input file given
-  istream* input_stream = &cin;
-  if (argc == 2)
-    input_stream = new ifstream(argv[1]);
+  string file_name;
+  // run on the bytecode VM instead of the tree-walking interpreter
+  bool use_vm = false;
+  // report garbage collector statistics (to stderr) at exit
+  bool gc_stats = false;
+  // heap size in bytes that triggers a collection (0 for the default)
+  size_t gc_threshold = 0;
+  // flush program output on each newline, or only at exit
+  bool line_flush = false;
+  // profile user functions, reporting to stderr or to the given file
+  bool profile = false;
+  string profile_file;
+  // skip constant folding and propagation (and instruction fusion)
+  bool optimize = true;
+  // report the superinstructions made for the VM (to stderr)
+  bool super_stats = false;
+  // report field inline cache hits and misses (to stderr) at exit
+  bool field_cache_stats = false;
+  // the most calls that can be active at once (0 for the default); the
+  // interpreter also stops when the host stack runs low, so only the VM
+  // can go deeper than the host stack allows
+  size_t max_stack_depth = 0;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "--vm")
+      use_vm = true;
+    else if (arg == "--gc-stats")
+      gc_stats = true;
+    else if (arg.compare(0, 15, "--gc-threshold=") == 0) {
+      if (!parse_count(arg.substr(15), gc_threshold)) {
+        cerr << "mypl: --gc-threshold expects a size in bytes" << endl;
+        return 1;
+      }
+    }
+    else if (arg == "--flush=line")
+      line_flush = true;
+    else if (arg == "--flush=exit")
+      line_flush = false;
+    else if (arg == "--no-optimize")
+      optimize = false;
+    else if (arg == "--super-stats")
+      super_stats = true;
+    else if (arg == "--field-cache-stats")
+      field_cache_stats = true;
+    else if (arg.compare(0, 18, "--max-stack-depth=") == 0) {
+      if (!parse_count(arg.substr(18), max_stack_depth) or
+          max_stack_depth == 0) {
+        cerr << "mypl: --max-stack-depth expects a number of calls" << endl;
+        return 1;
+      }
+    }
+    else if (arg == "--profile")
+      profile = true;
+    else if (arg.compare(0, 10, "--profile=") == 0) {
+      profile = true;
+      profile_file = arg.substr(10);
+    }
+    else
+      file_name = arg;
+  }
 
-  // create the lexer
-  Lexer lexer(*input_stream);
-  Parser parser(lexer);
+  // create the lexer (the source file is memory-mapped)
+  Lexer* lexer = file_name.empty() ? new Lexer(cin) : new Lexer(file_name);
+  Parser parser(*lexer);
   // read each token in the file until EOS or error
   Interpreter interpreter;
+  Profiler profiler;
+  int ret_code = 0;
   try {
     Program ast_root_node;
     parser.parse(ast_root_node);
     TypeChecker type_checker;
     ast_root_node.accept(type_checker);
-    ast_root_node.accept(interpreter);
+    if (optimize) {
+      Optimizer optimizer(ast_root_node.arena);
+      ast_root_node.accept(optimizer);
+    }
+    if (use_vm) {
+      Bytecode bytecode;
+      Compiler compiler(bytecode);
+      ast_root_node.accept(compiler);
+      if (optimize) {
+        Peephole peephole;
+        peephole.run(bytecode);
+        if (super_stats)
+          peephole.report(cerr);
+      }
+      VM vm(bytecode);
+      if (gc_threshold)
+        vm.get_heap().set_threshold(gc_threshold);
+      if (profile)
+        vm.set_profiler(&profiler);
+      if (max_stack_depth)
+        vm.set_max_stack_depth(max_stack_depth);
+      vm.set_line_flush(line_flush);
+      vm.run();
+      ret_code = vm.return_code();
+      if (gc_stats)
+        vm.get_heap().print_stats(cerr);
+      if (field_cache_stats)
+        write_field_stats(vm.get_field_stats());
+    }
+    else {
+      if (gc_threshold)
+        interpreter.get_heap().set_threshold(gc_threshold);
+      if (profile)
+        interpreter.set_profiler(&profiler);
+      if (max_stack_depth)
+        interpreter.set_max_stack_depth(max_stack_depth);
+      interpreter.set_line_flush(line_flush);
+      ast_root_node.accept(interpreter);
+      ret_code = interpreter.return_code();
+      if (gc_stats)
+        interpreter.get_heap().print_stats(cerr);
+      if (field_cache_stats)
+        write_field_stats(interpreter.get_field_stats());
+    }
   } catch (MyPLException e) {
     cout << e.to_string() << endl;
+    if (profile)
+      write_profile(profiler, profile_file);
     exit(1);
   }
-  // clean up the input stream
-  if (input_stream != &cin)
-    delete input_stream;
-  return interpreter.return_code();
+  if (profile)
+    write_profile(profiler, profile_file);
+  // clean up the lexer
+  delete lexer;
+  return ret_code;
 }
 
@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: interner.h
+// DATE: 10/17/2026
+// DESC: Global string interner for MyPL. Each distinct lexeme is
+//       stored once and named by a 32-bit symbol id, so tokens stay
+//       small and identifiers compare as integers.
+//----------------------------------------------------------------------
+
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+// an interned string's id (0 is the empty string)
+typedef uint32_t Symbol;
+
+
+class Interner
+{
+public:
+
+  // return the id of the string, adding it if it is new
+  static Symbol intern(const std::string& str);
+
+  // return the string with the given id
+  static const std::string& name(Symbol id);
+
+private:
+
+  Interner();
+
+  // the one table shared by every token
+  static Interner& table();
+
+  // string to id (map keys never move, so names can point at them)
+  std::unordered_map<std::string,Symbol> ids;
+
+  // id to string
+  std::vector<const std::string*> names;
+};
+
+
+Interner::Interner()
+{
+  auto it = ids.emplace("", 0).first;
+  names.push_back(&it->first);
+}
+
+
+Interner& Interner::table()
+{
+  static Interner interner;
+  return interner;
+}
+
+
+Symbol Interner::intern(const std::string& str)
+{
+  Interner& t = table();
+  auto it = t.ids.find(str);
+  if (it != t.ids.end())
+    return it->second;
+  Symbol id = t.names.size();
+  it = t.ids.emplace(str, id).first;
+  t.names.push_back(&it->first);
+  return id;
+}
+
+
+const std::string& Interner::name(Symbol id)
+{
+  return *table().names[id];
+}
+
+
+#endif
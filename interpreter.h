@@ -9,13 +9,15 @@
 #ifndef INTERPRETER_H
 #define INTERPRETER_H
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <unordered_map>
-#include <regex>
+#include <sys/resource.h>
 #include "ast.h"
-#include "symbol_table.h"
 #include "data_object.h"
 #include "heap.h"
+#include "profiler.h"
 
 
 class Interpreter : public Visitor
@@ -49,14 +51,50 @@ public:
   // return code from calling main
   int return_code() const;
   bool debugFlag = false;
+
+  // the object heap (for collector settings and statistics)
+  Heap& get_heap();
+
+  // record user function calls and allocations (nullptr to disable)
+  void set_profiler(Profiler* prof);
+
+  // flush output after each print of a newline (instead of at exit)
+  void set_line_flush(bool flush);
+
+  // the most calls that can be active at once (more is a runtime
+  // error rather than a host stack overflow); calls also stop once the
+  // host stack runs low, so a limit above what the host stack holds
+  // has no effect here (the VM has no such bound)
+  void set_max_stack_depth(size_t depth);
+
+  // field inline cache hits and misses so far
+  const FieldCacheStats& get_field_stats() const;
   
 private:
 
-  // return exception
-  class MyPLReturnException : public std::exception {};
+  // set by a return statement; statement loops stop when it is set
+  // and the call clears it (cheaper than throwing on every return)
+  bool returning = false;
+
+  // set (along with returning) by a tail call to the function whose
+  // body the current frame runs next
+  FunDecl* tail_call = nullptr;
+
+  // active calls (tail calls don't add one) and the limit
+  size_t depth = 0;
+  size_t max_depth = 100000;
+
+  // each call recurses on the host stack, so calls also stop (with a
+  // host stack exhausted error) once the stack in use since the program
+  // started nears the host's limit; how many calls fit depends on the
+  // frame size, not on max_depth
+  uintptr_t stack_base = 0;
+  size_t stack_room = 0;
   
-  // the symbol table 
-  SymbolTable sym_table;
+  // variable slots of every active call; the current call's slot 0
+  // is at frame_base (slots are assigned by the type checker)
+  std::vector<DataObject> locals;
+  size_t frame_base = 0;
 
   // holds the previously computed value
   DataObject curr_val;
@@ -66,16 +104,26 @@ private:
 
   // the next oid
   size_t next_oid = 0;
+
+  // the profiler (if profiling)
+  Profiler* profiler = nullptr;
+
+  // output flush policy
+  bool line_flush = false;
   
   // the functions (all within the global environment)
-  std::unordered_map<std::string,FunDecl*> functions;
+  std::unordered_map<Symbol,FunDecl*> functions;
   
   // the user-defined types (all within the global environment)
-  std::unordered_map<std::string,TypeDecl*> types;
-  std::unordered_map<std::string, tuple<std::string,DataObject>> intAddress;
+  std::unordered_map<Symbol,TypeDecl*> types;
+
+  // the field layout of each user-defined type
+  std::unordered_map<Symbol,Shape> shapes;
 
-  // the global environment id
-  int global_env_id = 0;
+  // an inline cache per field access site (numbered by the type
+  // checker), kept here so running the program leaves the tree as is
+  std::vector<FieldCache> field_caches;
+  FieldCacheStats field_stats;
   
   // the program return code
   int ret_code = 0;
@@ -84,7 +132,28 @@ private:
   void error(const std::string& msg, const Token& token);
   void error(const std::string& msg); 
   void debug(std::string msg);
-  std::string currPtr;
+
+  // a pointer (~) variable or parameter holds a reference (a REF
+  // value): the absolute locals index of the slot it points at. For &x or ~q set
+  // addr and return true, otherwise evaluate expr into curr_val (the
+  // caller stores it in a cell) and return false
+  bool reference(Expr& expr, size_t& addr);
+
+  // the offset of a path step's field in obj, through the site's cache
+  int field_offset(int site, const HeapObject& obj);
+
+  // run statements in order, stopping early on a return
+  void run_stmts(Span<Stmt*>& stmts);
+
+  // apply a type-specialized operation to lhs_val and curr_val (the
+  // rhs), leaving the result in curr_val; false (and nothing done) if
+  // an operand is not of the kernel's type, e.g., nil
+  bool run_kernel(Kernel kernel, DataObject& lhs_val);
+
+  // mark everything reachable from the locals and curr_val, then
+  // free the rest of the heap (references are not oids and are
+  // skipped)
+  void collect_garbage();
 };
 
 
@@ -94,6 +163,70 @@ int Interpreter::return_code() const
   return ret_code;
 }
 
+Heap& Interpreter::get_heap()
+{
+  return heap;
+}
+
+void Interpreter::set_profiler(Profiler* prof)
+{
+  profiler = prof;
+}
+
+void Interpreter::set_line_flush(bool flush)
+{
+  line_flush = flush;
+}
+
+void Interpreter::set_max_stack_depth(size_t depth)
+{
+  max_depth = depth;
+}
+
+const FieldCacheStats& Interpreter::get_field_stats() const
+{
+  return field_stats;
+}
+
+void Interpreter::collect_garbage()
+{
+  for (const DataObject& val : locals)
+    heap.mark(val);
+  heap.mark(curr_val);
+  heap.sweep();
+}
+
+bool Interpreter::reference(Expr& expr, size_t& addr)
+{
+  SimpleTerm* term = dynamic_cast<SimpleTerm*>(expr.first);
+  if (!expr.negated && !expr.op && term) {
+    if (PointerValue* v = dynamic_cast<PointerValue*>(term->rvalue)) {
+      addr = frame_base + v->slot;
+      return true;
+    }
+    if (PointerType* p = dynamic_cast<PointerType*>(term->rvalue)) {
+      locals[frame_base + p->slot].ref(addr);
+      return true;
+    }
+  }
+  expr.accept(*this);
+  return false;
+}
+
+int Interpreter::field_offset(int site, const HeapObject& obj)
+{
+  return field_caches[site].offset(obj.get_shape(), field_stats);
+}
+
+void Interpreter::run_stmts(Span<Stmt*>& stmts)
+{
+  for (Stmt* s : stmts) {
+    s->accept(*this);
+    if (returning)
+      return;
+  }
+}
+
 void Interpreter::error(const std::string& msg, const Token& token)
 {
   throw MyPLException(RUNTIME, msg, token.line(), token.column());
@@ -116,57 +249,64 @@ void Interpreter::debug(std::string msg)
 void Interpreter::visit(Program& node) 
 {
   debug("<program>");
-  //push the global 
-  sym_table.push_environment();
-  
-  //store the global environment id
-  global_env_id = sym_table.get_environment_id();
-
   for (Decl* d : node.decls) {
     d->accept(*this);
   }
+  //seed each field site's cache with its type's shape (the shapes
+  //are made by the type declarations above)
+  field_caches.clear();
+  for (const FieldSite& site : node.field_sites)
+    field_caches.push_back(FieldCache(&shapes[site.type], site.offset));
+
+  //leave a quarter of the host stack (at most 8 MB is assumed) spare
+  char base;
+  stack_base = reinterpret_cast<uintptr_t>(&base);
+  struct rlimit limit;
+  size_t size = 8 << 20;
+  if (getrlimit(RLIMIT_STACK, &limit) == 0 && limit.rlim_cur < size)
+    size = limit.rlim_cur;
+  stack_room = size / 4 * 3;
 
   //execute the main function
   CallExpr expr;
-  expr.function_id = functions["main"]->id;
+  expr.function_id = functions[Interner::intern("main")]->id;
   expr.accept(*this);
-
-  //pop the global environment
-  sym_table.pop_environment();
 }
 
 void Interpreter::visit(FunDecl& node) 
 {
   debug("<FunDecl>");
-  //global_env_id = sym_table.get_environment_id();
-  FunDecl* fun = new FunDecl();
-  *fun = node;
-  functions[node.id.lexeme()] = fun;
+  //the program's arena owns the node, and outlives the run
+  functions[node.id.symbol()] = &node;
 }
 
 void Interpreter::visit(TypeDecl& node) 
 {
   debug("<TypeDecl>");
-  TypeDecl* d = new TypeDecl();
-  *d = node;
-  types[node.id.lexeme()] = d;
+  types[node.id.symbol()] = &node;
+  //every object of the type shares the same field layout
+  Shape& shape = shapes[node.id.symbol()];
+  shape.type_name = node.id.lexeme();
+  for (VarDeclStmt* v : node.vdecls)
+    shape.fields.push_back(v->id.lexeme());
 }
   // statements
 void Interpreter::visit(VarDeclStmt& node) 
 {
   debug("<VarDeclStmt>");
+  if (node.pointer) {
+    size_t addr = 0;
+    if (!reference(*node.expr, addr)) {
+      addr = frame_base + node.cell;
+      locals[addr] = curr_val;
+    }
+    locals[frame_base + node.slot].set_ref(addr);
+    return;
+  }
   if (node.expr != nullptr) {
     node.expr->accept(*this);
   }
-  sym_table.add_name(node.id.lexeme());
-  //cout << curr_val.to_string() << endl;
-  sym_table.set_val_info(node.id.lexeme(), curr_val);
-  DataObject test;
-  sym_table.get_val_info(node.id.lexeme(), test);
-  //cout << node.id.lexeme() << " is " << test.to_string() << endl;
-  if (node.pointer) {
-    intAddress.insert({node.id.lexeme(), make_tuple(currPtr, curr_val)});
-  }
+  locals[frame_base + node.slot] = curr_val;
 }
 void Interpreter::visit(AssignStmt& node) 
 {
@@ -176,47 +316,37 @@ void Interpreter::visit(AssignStmt& node)
     node.expr->accept(*this);
   }
   DataObject rhs = curr_val;
+  //a ~ path starts at the slot the pointer refers to
+  size_t target = frame_base + node.slot;
+  if (node.lvalue_list.front().type() == POINTER_TYPE)
+    locals[target].ref(target);
   //check if path is size 1
   if (node.lvalue_list.size() == 1) {
-    sym_table.set_val_info(node.lvalue_list.front().lexeme(), rhs);
+    locals[target] = rhs;
   }
 
   //this means path is greater than 1
   else { 
-    HeapObject obj;
-    std::list<Token>::iterator it = node.lvalue_list.begin();
-    sym_table.get_val_info(it->lexeme(), curr_val);
+    HeapObject* obj = nullptr;
+    size_t oid = 0;
+    const Token* it = node.lvalue_list.begin();
+    curr_val = locals[target];
     ++it;
-    while (it != node.lvalue_list.end()) {
-      size_t oid;
-      curr_val.value(oid);
-      if (heap.has_obj(oid)) {
-        heap.get_obj(oid, obj);
-        obj.get_val(it->lexeme(), curr_val);
-      }
-      else if (it != node.lvalue_list.end()) {
+    //walk to the object that owns the last attribute in the path
+    int site = node.site;
+    while (true) {
+      if (!curr_val.value(oid) || !(obj = heap.get_obj(oid))) {
         error("no attribute name", *it);
       }
-      obj.set_att(it->lexeme(), curr_val);
-      it++;
-    }
-    obj.set_att(it->lexeme(), rhs);
-  }
-  
-  unordered_map<std::string, tuple<std::string, DataObject>>::iterator itr = intAddress.begin();
-  while (itr != intAddress.end()) {
-    if (get<0>(itr->second) == node.lvalue_list.front().lexeme()) {
-      get<1>(itr->second) = rhs;
+      if (it + 1 == node.lvalue_list.end()) {
+        break;
+      }
+      curr_val = obj->get_field(field_offset(site, *obj));
+      ++it;
+      ++site;
     }
-    itr++;
-  }
-
-  //i think the problem is with the environemnt
-  if (intAddress.count(node.lvalue_list.front().lexeme()) > 0) {
-    //intAddress[node.lvalue_list.front().lexeme()] = make_tuple(currPtr, rhs);
-    intAddress[node.lvalue_list.front().lexeme()] = make_tuple(get<0>(intAddress[node.lvalue_list.front().lexeme()]), rhs);
-    //sym_table.set_val_info(currPtr, rhs);
-    sym_table.set_val_info(get<0>(intAddress[node.lvalue_list.front().lexeme()]), rhs);
+    //update the attribute in place
+    heap.set_field(*obj, field_offset(site, *obj), std::move(rhs));
   }
 }
 void Interpreter::visit(ReturnStmt& node) 
@@ -228,9 +358,8 @@ void Interpreter::visit(ReturnStmt& node)
   if (node.expr != nullptr) {
     node.expr->accept(*this);
   }
-  //cout << " here in return statmtnju";
-  //throw the return exception
-  throw new MyPLReturnException;
+  //signal the enclosing statement loops to stop
+  returning = true;
 }
 void Interpreter::visit(IfStmt& node) 
 {
@@ -240,9 +369,7 @@ void Interpreter::visit(IfStmt& node)
   //bool found = false;
   curr_val.value(cond);
   if (cond) {
-    for (Stmt* s : node.if_part->stmts) {
-      s->accept(*this);
-    }
+    run_stmts(node.if_part->stmts);
   }
   else if (!node.else_ifs.empty()) {
     for (BasicIf* b : node.else_ifs) {
@@ -250,17 +377,13 @@ void Interpreter::visit(IfStmt& node)
         b->expr->accept(*this);
         curr_val.value(cond);
         if (cond) {
-          for (Stmt* s : b->stmts) {
-            s->accept(*this);
-          }
+          run_stmts(b->stmts);
         }
       }
     }
   }
   if (!cond) {
-    for (Stmt* s : node.body_stmts) {
-      s->accept(*this);
-    }
+    run_stmts(node.body_stmts);
   }
 }
 
@@ -273,8 +396,9 @@ void Interpreter::visit(WhileStmt& node)
   bool cond = false;
   curr_val.value(cond);
   while (cond) {
-    for (Stmt* s : node.stmts) {
-      s->accept(*this);
+    run_stmts(node.stmts);
+    if (returning) {
+      return;
     }
     node.expr->accept(*this);
     curr_val.value(cond);
@@ -284,11 +408,6 @@ void Interpreter::visit(WhileStmt& node)
 void Interpreter::visit(ForStmt& node) 
 {
   debug("<ForStmt>");
-  //push environment
-  sym_table.push_environment();
-
-  sym_table.add_name(node.var_id.lexeme());
-
   //get the curr_val of start expr
   if (node.start != nullptr) {
     node.start->accept(*this);
@@ -303,25 +422,31 @@ void Interpreter::visit(ForStmt& node)
   int rest_val;
   curr_val.value(rest_val);
 
-  DataObject loop = new DataObject(start_val);
-  sym_table.set_val_info(node.var_id.lexeme(), loop);
+  locals[frame_base + node.slot].set(start_val);
+
+  //the body never sets the loop variable, so the counter stays here
+  if (node.counted) {
+    while (start_val <= rest_val) {
+      run_stmts(node.stmts);
+      if (returning) {
+        return;
+      }
+      locals[frame_base + node.slot].set(++start_val);
+    }
+    return;
+  }
 
   //keep looping if the expr is true
-  //loop.value(start_val);
-  while (start_val < rest_val) {
-    sym_table.push_environment();
-    for (Stmt* s : node.stmts) {
-      s->accept(*this);
+  while (start_val <= rest_val) {
+    run_stmts(node.stmts);
+    if (returning) {
+      return;
     }
-    sym_table.pop_environment();
-    //update the curr_val
-    sym_table.get_val_info(node.var_id.lexeme(), loop);
-    loop.value(start_val);
+    //update the loop variable (the body may have changed it)
+    locals[frame_base + node.slot].value(start_val);
     start_val++;
-    loop.set(start_val);
-    sym_table.set_val_info(node.var_id.lexeme(), loop);
+    locals[frame_base + node.slot].set(start_val);
   }
-  sym_table.pop_environment();
 }
   // expressions
 void Interpreter::visit(Expr& node) 
@@ -336,17 +461,25 @@ void Interpreter::visit(Expr& node)
   else {
     node.first->accept(*this);
     if (node.op) {
-      DataObject lhs_val = curr_val;
+      //and/or stop once the lhs decides the result (curr_val holds it)
+      bool cond;
+      if ((node.bin_op == BinOp::AND || node.bin_op == BinOp::OR) &&
+          curr_val.value(cond) && cond == (node.bin_op == BinOp::OR))
+        return;
+      DataObject lhs_val = std::move(curr_val);
       node.rest->accept(*this);
+      //operands of known types skip the checks below
+      if (node.kernel != Kernel::GENERIC && run_kernel(node.kernel, lhs_val))
+        return;
       DataObject rhs_val = curr_val;
-      TokenType op = node.op->type();
       //cout << node.first_token().to_string() << " at first " << endl;
       //start checking various cases (there are many)
 
       //be sure to set the computed value in curr_val
 
       //need to go throughmath operators (+, -, *, /, %)
-      if (op == PLUS) {
+      switch (node.bin_op) {
+      case BinOp::ADD: {
         if (lhs_val.is_nil()) {
           error("cant do operation on nil value", node.first_token());
         }
@@ -407,7 +540,8 @@ void Interpreter::visit(Expr& node)
           curr_val.set(l_val+r_val);
         }
       }
-      else if (op == MINUS) {
+      break;
+      case BinOp::SUB: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do minus operation on a nil value", node.first_token());
         }
@@ -428,7 +562,8 @@ void Interpreter::visit(Expr& node)
           curr_val.set(l_val - r_val);
         }
       }
-      else if (op == MULTIPLY) {
+      break;
+      case BinOp::MUL: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do multiplication operation on a nil value", node.first_token());
         }
@@ -449,7 +584,8 @@ void Interpreter::visit(Expr& node)
           curr_val.set(l_val * r_val);
         }
       }
-      else if (op == DIVIDE) {
+      break;
+      case BinOp::DIV: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do division operation on a nil value", node.first_token());
         }
@@ -470,7 +606,8 @@ void Interpreter::visit(Expr& node)
           curr_val.set(l_val / r_val);
         }
       }
-      else if (op == MODULO) {
+      break;
+      case BinOp::MOD: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do modulo operation on a nil value", node.first_token());
         }
@@ -483,8 +620,9 @@ void Interpreter::visit(Expr& node)
           curr_val.set(l_val % r_val);
         }
       }
+      break;
       //and operation
-      else if (op == AND) {
+      case BinOp::AND: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("can't use AND with a nil", node.first_token());
         }
@@ -494,7 +632,8 @@ void Interpreter::visit(Expr& node)
         rhs_val.value(r_val);
         curr_val.set(l_val && r_val);
       }
-      else if (op == OR) {
+      break;
+      case BinOp::OR: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("can't use OR with a nil", node.first_token());
         }
@@ -504,10 +643,11 @@ void Interpreter::visit(Expr& node)
         rhs_val.value(r_val);
         curr_val.set(l_val || r_val);
       }
+      break;
       //now we need to look at relational operators (=, !=, <, >, <=, >=)
       
       //operator equal to
-      else if (op == EQUAL) {
+      case BinOp::EQ: {
         if (lhs_val.is_nil() ^ rhs_val.is_nil()) {
           curr_val.set(false);
         }
@@ -524,8 +664,9 @@ void Interpreter::visit(Expr& node)
           }
         }
       }
+      break;
       //operator not equal
-      else if (op == NOT_EQUAL) {
+      case BinOp::NE: {
         if (lhs_val.is_nil() ^ rhs_val.is_nil()) {
           curr_val.set(true);
         }
@@ -542,8 +683,9 @@ void Interpreter::visit(Expr& node)
           }
         }
       }
+      break;
       //operator less than
-      else if (op == LESS) {
+      case BinOp::LT: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do operation on nil", node.first_token());
         }
@@ -596,8 +738,9 @@ void Interpreter::visit(Expr& node)
           }
         }
       }
+      break;
       //operator less than or equal
-      else if (op == LESS_EQUAL) {
+      case BinOp::LE: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do operation on nil", node.first_token());
         }
@@ -650,8 +793,9 @@ void Interpreter::visit(Expr& node)
           }
         }
       }
+      break;
       //operator greater than
-      else if (op == GREATER) {
+      case BinOp::GT: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do operation on nil", node.first_token());
         }
@@ -705,8 +849,9 @@ void Interpreter::visit(Expr& node)
           }
         }
       }
+      break;
       //operator greater than or equal
-      else if (op == GREATER_EQUAL) {
+      case BinOp::GE: {
         if (lhs_val.is_nil() || rhs_val.is_nil()) {
           error("cant do operation on nil", node.first_token());
         }
@@ -759,9 +904,60 @@ void Interpreter::visit(Expr& node)
           }
         }
       }
+      break;
+      default:
+        break;
+      }
     }
   }
 }
+bool Interpreter::run_kernel(Kernel kernel, DataObject& lhs_val)
+{
+  if (kernel == Kernel::STRING_CONCAT) {
+    if (!lhs_val.append(curr_val))
+      return false;
+    curr_val = std::move(lhs_val);
+    return true;
+  }
+  if (kernel >= Kernel::DOUBLE_ADD) {
+    double l_val;
+    double r_val;
+    if (!lhs_val.value(l_val) || !curr_val.value(r_val))
+      return false;
+    switch (kernel) {
+      case Kernel::DOUBLE_ADD: curr_val.set(l_val + r_val); break;
+      case Kernel::DOUBLE_SUB: curr_val.set(l_val - r_val); break;
+      case Kernel::DOUBLE_MUL: curr_val.set(l_val * r_val); break;
+      case Kernel::DOUBLE_DIV: curr_val.set(l_val / r_val); break;
+      case Kernel::DOUBLE_LT: curr_val.set(l_val < r_val); break;
+      case Kernel::DOUBLE_LE: curr_val.set(l_val <= r_val); break;
+      case Kernel::DOUBLE_GT: curr_val.set(l_val > r_val); break;
+      case Kernel::DOUBLE_GE: curr_val.set(l_val >= r_val); break;
+      default: return false;
+    }
+    return true;
+  }
+  int l_val;
+  int r_val;
+  if (!lhs_val.value(l_val) || !curr_val.value(r_val))
+    return false;
+  switch (kernel) {
+    case Kernel::INT_ADD: curr_val.set(l_val + r_val); break;
+    case Kernel::INT_SUB: curr_val.set(l_val - r_val); break;
+    case Kernel::INT_MUL: curr_val.set(l_val * r_val); break;
+    case Kernel::INT_DIV: curr_val.set(l_val / r_val); break;
+    case Kernel::INT_MOD: curr_val.set(l_val % r_val); break;
+    case Kernel::INT_EQ: curr_val.set(l_val == r_val); break;
+    case Kernel::INT_NE: curr_val.set(l_val != r_val); break;
+    case Kernel::INT_LT: curr_val.set(l_val < r_val); break;
+    case Kernel::INT_LE: curr_val.set(l_val <= r_val); break;
+    case Kernel::INT_GT: curr_val.set(l_val > r_val); break;
+    case Kernel::INT_GE: curr_val.set(l_val >= r_val); break;
+    default: return false;
+  }
+  return true;
+}
+
 void Interpreter::visit(SimpleTerm& node) 
 {
   debug("<SimpleTerm>");
@@ -780,6 +976,11 @@ void Interpreter::visit(ComplexTerm& node)
 void Interpreter::visit(SimpleRValue& node) 
 {
   debug("<SimpleRValue>");
+  //literals are decoded once by the type checker
+  if (node.decoded) {
+    curr_val = node.val;
+    return;
+  }
   if (node.value.type() == CHAR_VAL)
     curr_val.set(node.value.lexeme().at(0));
   else if (node.value.type() == STRING_VAL) 
@@ -819,41 +1020,57 @@ void Interpreter::visit(SimpleRValue& node)
 void Interpreter::visit(NewRValue& node) 
 {
   debug("<NewRValue>");
-  HeapObject h;
+  // every live value is in a frame slot (call args included) or
+  // curr_val, so allocation is a safe point to collect
+  if (heap.needs_collection())
+    collect_garbage();
+  if (profiler)
+    profiler->count_alloc();
   //build the heap object
   //look up in types array
-  size_t oid = next_oid;
-  TypeDecl *t = types[node.type_id.lexeme()];
+  //(reserve the oid first, initializers may allocate objects too)
+  size_t oid = next_oid++;
+  TypeDecl *t = types[node.type_id.symbol()];
+  HeapObject h(&shapes[node.type_id.symbol()]);
+  //field initializers run in their own frame
+  size_t saved_base = frame_base;
+  frame_base = locals.size();
+  locals.resize(frame_base + t->frame_size);
+  int offset = 0;
   for (VarDeclStmt* s : t->vdecls) {
-    if (s->expr != nullptr) {
-      s->expr->accept(*this);
-    }
-    else {
-      curr_val = nullptr;
-    }
-    h.set_att(s->id.lexeme(), curr_val);
+    s->accept(*this);
+    h.set_field(offset++, curr_val);
   }
-  heap.set_obj(oid, h);
+  locals.resize(frame_base);
+  frame_base = saved_base;
+  heap.set_obj(oid, std::move(h));
   curr_val.set(oid);
-  next_oid++;
-  sym_table.add_name(node.type_id.lexeme());
-  sym_table.set_val_info(node.type_id.lexeme(), curr_val);
 }
 
 void Interpreter::visit(CallExpr& node) 
 {
   debug("<CallExpr>");
-  std::string fun_name = node.function_id.lexeme();
+  // built-in function names, interned once
+  static const Symbol PRINT = Interner::intern("print");
+  static const Symbol STOI = Interner::intern("stoi");
+  static const Symbol STOD = Interner::intern("stod");
+  static const Symbol ITOS = Interner::intern("itos");
+  static const Symbol DTOS = Interner::intern("dtos");
+  static const Symbol GET = Interner::intern("get");
+  static const Symbol LENGTH = Interner::intern("length");
+  static const Symbol READ = Interner::intern("read");
+  Symbol fun_name = node.function_id.symbol();
   // check for built - in functions
-  if (fun_name == "print") {
+  if (fun_name == PRINT) {
     node.arg_list.front()->accept(*this);
+    //escapes were decoded by the lexer, so this is a plain write
     std::string s = curr_val.to_string();
-    s = std::regex_replace(s, std::regex("\\\\n"), "\n");
-    s = std::regex_replace(s, std::regex("\\\\t"), "\t");
-    std::cout << s;
+    std::cout.write(s.data(), s.size());
+    if (line_flush && s.find('\n') != std::string::npos)
+      std::cout.flush();
   }
  
-  else if (fun_name == "stoi") {
+  else if (fun_name == STOI) {
     node.arg_list.front()->accept(*this);
     try {
       curr_val.set(stoi(curr_val.to_string()));
@@ -865,7 +1082,7 @@ void Interpreter::visit(CallExpr& node)
       error ("int out of range", node.function_id);
     }
   }
-  else if (fun_name == "stod") {
+  else if (fun_name == STOD) {
     node.arg_list.front()->accept(*this);
     try {
       curr_val.set(stod(curr_val.to_string()));
@@ -877,19 +1094,19 @@ void Interpreter::visit(CallExpr& node)
       error ("int out of range", node.function_id);
     }
   }
-  else if (fun_name == "itos") {
+  else if (fun_name == ITOS) {
     node.arg_list.front()->accept(*this);
     int val;
     curr_val.value(val);
     curr_val.set(to_string(val));
   }
-  else if (fun_name == "dtos") {
+  else if (fun_name == DTOS) {
     node.arg_list.front()->accept(*this);
     double val;
     curr_val.value(val);
     curr_val.set(to_string(val));
   }
-  else if (fun_name == "get") {
+  else if (fun_name == GET) {
     node.arg_list.front()->accept(*this);
     int i;
     curr_val.value(i);
@@ -908,13 +1125,13 @@ void Interpreter::visit(CallExpr& node)
       error("int out of range", node.function_id);
     }
   }
-  else if (fun_name == "length") {
+  else if (fun_name == LENGTH) {
     node.arg_list.front()->accept(*this);
     std::string s = curr_val.to_string();
     int size = s.length();
     curr_val.set(size);
   }
-  else if (fun_name == "read") {
+  else if (fun_name == READ) {
     //node.arg_list.front()->accept(*this);
     std::string str;
     cin >> str;
@@ -923,73 +1140,104 @@ void Interpreter::visit(CallExpr& node)
 
   else {
     //call the function
-    // 1. evaluate the args and save
-    // 2. save the current environment
-    // 3. go to the gobal environment
-    // 4. push a new environment
-    // 5. add param values ( from 1)
-    // 6. eval each statement
-    // 7. catch a return exception
-    // 8. pop environment
-    // 9. return to saved environment
+    // 1. evaluate the args onto the end of locals (the param slots)
+    // 2. save the current frame base
+    // 3. grow the new frame to its full size (from the type checker)
+    // 4. eval each statement (until a return)
+    // 5. clear the return flag
+    // 6. pop the frame
+    // 7. return to saved frame base
 
     FunDecl* fun_node = functions[fun_name];
+    if (node.tail) {
+      //a tail call reuses the current frame: the args are evaluated
+      //above it and moved down to its param slots, then the return
+      //unwinds to the call that owns the frame, which runs the body
+      size_t args = locals.size();
+      for (Expr* e : node.arg_list) {
+        e->accept(*this);
+        locals.push_back(curr_val);
+      }
+      if (args != frame_base)
+        std::move(locals.begin() + args, locals.end(),
+                  locals.begin() + frame_base);
+      locals.resize(frame_base + node.arg_list.size());
+      locals.resize(frame_base + fun_node->frame_size);
+      tail_call = fun_node;
+      returning = true;
+      return;
+    }
+    char here;
+    if (depth == max_depth)
+      error("stack overflow: more than " + std::to_string(max_depth) +
+            " active calls", node.function_id);
+    if (stack_base - reinterpret_cast<uintptr_t>(&here) > stack_room)
+      error("stack overflow: host stack exhausted", node.function_id);
+    ++depth;
     //...
-    //define a map first
-    unordered_map<std::string, DataObject> map;
-    std::list<FunDecl::FunParam>::iterator it = fun_node->params.begin();
+    //evaluate the args first, straight into the new frame's param
+    //slots (nested calls stack their frames above them, and they
+    //stay visible to the garbage collector)
+    //pointer params get a reference instead; a value passed to one is
+    //held in a cell past the end of the new frame
+    size_t new_base = locals.size();
+    std::vector<size_t> cells;
+    const FunDecl::FunParam* param = fun_node->params.begin();
     for (Expr* e : node.arg_list) {
-      e->accept(*this);
-      //build the map
-      map[it->id.lexeme()] = curr_val;
-      it++;
+      size_t addr = 0;
+      if (param->id.type() != POINTER_TYPE)
+        e->accept(*this);
+      else if (reference(*e, addr))
+        curr_val.set_ref(addr);
+      else
+        cells.push_back(locals.size());
+      locals.push_back(curr_val);
+      ++param;
     }
-    int curr_env = sym_table.get_environment_id();
-    sym_table.set_environment_id(global_env_id);
-    sym_table.push_environment();
-    //what to do with (5)
-    //put map values in symbol table
-    //add name and set value in symbol table
-    for (FunDecl::FunParam f : fun_node->params) {
-      sym_table.add_name(f.id.lexeme());
-      sym_table.set_val_info(f.id.lexeme(), map[f.id.lexeme()]);
+    //then push the rest of the new frame
+    size_t saved_base = frame_base;
+    frame_base = new_base;
+    locals.resize(frame_base + fun_node->frame_size);
+    for (size_t slot : cells) {
+      locals.push_back(locals[slot]);
+      locals[slot].set_ref(locals.size() - 1);
     }
-    try {
-      for (Stmt* s : fun_node->stmts) {
-        s->accept(*this);
+    if (profiler)
+      profiler->enter(node.function_id.lexeme());
+    run_stmts(fun_node->stmts);
+    while (tail_call) {
+      FunDecl* callee = tail_call;
+      tail_call = nullptr;
+      returning = false;
+      if (profiler) {
+        profiler->exit();
+        profiler->enter(callee->id.lexeme());
       }
+      run_stmts(callee->stmts);
     }
-    catch (MyPLReturnException* e) {
-      
-    }
-    sym_table.pop_environment();
-    sym_table.set_environment_id(curr_env);
+    returning = false;
+    if (profiler)
+      profiler->exit();
+    locals.resize(frame_base);
+    frame_base = saved_base;
+    --depth;
   }
 }
 
 void Interpreter::visit(IDRValue& node) 
 {
   debug("<IDRValue>");
-  std::list<Token>::iterator it = node.path.begin();
-  sym_table.get_val_info(it->lexeme(), curr_val);
+  const Token* it = node.path.begin();
+  curr_val = locals[frame_base + node.slot];
   it++;
   //cout << " in idrvalue";
-  for (; it != node.path.end(); ++it) {
-    HeapObject obj;
-    size_t oid = 20;
-    curr_val.value(oid);
-    /*
-    if (heap.get_obj(oid, obj)) {
-      obj.get_val(it->lexeme(), curr_val);
-    }
-    */
-    if (heap.has_obj(oid)) {
-      heap.get_obj(oid, obj);
-      obj.get_val(it->lexeme(), curr_val);
-    }
-    else {
+  for (int site = node.site; it != node.path.end(); ++it, ++site) {
+    size_t oid = 0;
+    HeapObject* obj = nullptr;
+    if (!curr_val.value(oid) || !(obj = heap.get_obj(oid))) {
       error("no attribute name ", *it);
     }
+    curr_val = obj->get_field(field_offset(site, *obj));
   }
   //cout << "end of idrvalue" << endl;
 }
@@ -1014,22 +1262,17 @@ void Interpreter::visit(NegatedRValue& node)
 
 void Interpreter::visit(PointerType& node)
 {
-  //std::string str = node.pointer.lexeme();
-  //sym_table.get_val_info(str, curr_val);
-  //cout << "here " << curr_val.to_string() << endl;
-  unordered_map<std::string, tuple<std::string, DataObject>>::iterator itr;
-  itr = intAddress.find(node.pointer.lexeme());
-  curr_val = get<1>(itr->second);
+  //read through the reference
+  size_t addr = 0;
+  locals[frame_base + node.slot].ref(addr);
+  curr_val = locals[addr];
 }
 
+// &x used as a value (outside a pointer declaration or argument) is
+// the value of x
 void Interpreter::visit(PointerValue& node)
 {
-  std::string str = node.pointer.lexeme();
-  str = str.substr(1);
- // cout << str << endl;
-  sym_table.get_val_info(str, curr_val);
-  currPtr = str;
-  //cout << str + " " << curr_val.to_string() << endl;
+  curr_val = locals[frame_base + node.slot];
 }
 
 #endif
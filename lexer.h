@@ -2,14 +2,24 @@
 // NAME: Weston Averill
 // FILE: lexer.h
 // DATE: 2/4/2021
-// DESC: Implement Lexer for MyPL
+// DESC: Implement Lexer for MyPL. The whole source is scanned from
+//       one contiguous buffer: a source file is memory-mapped, and a
+//       stream (e.g., standard input) is read in a single bulk read.
+//       Escape sequences in string and char literals are decoded here,
+//       so a literal's lexeme is its value.
 //----------------------------------------------------------------------
 
 #ifndef LEXER_H
 #define LEXER_H
 
+#include <fstream>
 #include <istream>
+#include <iterator>
 #include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "token.h"
 #include "mypl_exception.h"
 
@@ -17,46 +27,129 @@ class Lexer
 {
 public:
 
-  // construct a new lexer from the input stream
+  // construct a new lexer from the input stream (read all at once)
   Lexer(std::istream& input_stream);
 
+  // construct a new lexer from a source file (memory-mapped when
+  // possible, otherwise read all at once)
+  Lexer(const std::string& file_name);
+
+  // release the source buffer
+  ~Lexer();
+
+  // the lexer owns its mapping, so it can't be copied
+  Lexer(const Lexer&) = delete;
+  Lexer& operator=(const Lexer&) = delete;
+
   // return the next available token in the input stream (including
   // EOS if at the end of the stream)
   Token next_token();
   
 private:
 
-  // input stream, current line, and current column
-  std::istream& input_stream;
+  // the source text, either mapped from a file or read into buffer
+  std::string buffer;
+  void* mapped = nullptr;
+  size_t mapped_size = 0;
+
+  // the next character to scan and the end of the source text
+  const char* pos = nullptr;
+  const char* end = nullptr;
+
+  // current line and current column
   int line;
   int column;
 
+  // scan the given stream's contents from buffer
+  void load(std::istream& input_stream);
+
   // return a single character from the input stream and advance
   char read();
 
   // return a single character from the input stream without advancing
   char peek();
 
+  // the character denoted by an escape sequence (given the character
+  // after the backslash)
+  char escape(char ch, int line, int column) const;
+
   // create and throw a mypl_exception (exits the lexer)
   void error(const std::string& msg, int line, int column) const;
 };
 
 Lexer::Lexer(std::istream& input_stream)
-  : input_stream(input_stream), line(1), column(1)
+  : line(1), column(1)
+{
+  load(input_stream);
+}
+
+Lexer::Lexer(const std::string& file_name)
+  : line(1), column(1)
+{
+  int fd = open(file_name.c_str(), O_RDONLY);
+  struct stat info;
+  if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+    void* addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      mapped = addr;
+      mapped_size = info.st_size;
+      pos = static_cast<const char*>(addr);
+      end = pos + mapped_size;
+    }
+  }
+  if (fd >= 0)
+    close(fd);
+  //not mappable (empty, missing, or a pipe): fall back to reading it
+  if (!mapped) {
+    std::ifstream input_stream(file_name);
+    load(input_stream);
+  }
+}
+
+Lexer::~Lexer()
+{
+  if (mapped)
+    munmap(mapped, mapped_size);
+}
+
+void Lexer::load(std::istream& input_stream)
 {
+  buffer.assign(std::istreambuf_iterator<char>(input_stream),
+                std::istreambuf_iterator<char>());
+  pos = buffer.data();
+  end = pos + buffer.size();
 }
 
 char Lexer::read()
 {
-  return input_stream.get();
+  return pos < end ? *pos++ : EOF;
 }
 
 char Lexer::peek()
 {
-  return input_stream.peek();
+  return pos < end ? *pos : EOF;
 }
 
 
+char Lexer::escape(char ch, int line, int column) const
+{
+  switch (ch) {
+    case 'n': return '\n';
+    case 't': return '\t';
+    case 'r': return '\r';
+    case '0': return '\0';
+    case 'a': return '\a';
+    case 'b': return '\b';
+    case 'f': return '\f';
+    case 'v': return '\v';
+    case '\\': return '\\';
+    case '"': return '"';
+    case '\'': return '\'';
+  }
+  error("invalid escape sequence", line, column);
+  return ch;
+}
+
 void Lexer::error(const std::string& msg, int line, int column) const
 {
   throw MyPLException(LEXER, msg, line, column);
@@ -88,7 +181,7 @@ Token Lexer::next_token()
     bool extra = true;
     while (extra)
     {
-      while (ch != '\n')
+      while (ch != '\n' && ch != EOF)
       {
         ch = read();
         column++;
@@ -136,17 +229,13 @@ Token Lexer::next_token()
   else if (isalpha(ch))
   {
     //tempCol = column;
-    while (isalpha(ch) || ch == '_' || isdigit(ch))
+    const char* start = pos - 1;
+    while (isalpha(peek()) || peek() == '_' || isdigit(peek()))
     {
-      lexeme += ch;
-      if (isalpha(peek()) || peek() == '_' || isdigit(peek()))
-      {
-        ch = read();
-        column++;
-      }
-      else
-        break;
+      ++pos;
+      column++;
     }
+    lexeme.assign(start, pos);
     if (lexeme == "type")
       return Token(TYPE, lexeme, line, tempCol);
     if (lexeme == "bool")
@@ -203,37 +292,27 @@ Token Lexer::next_token()
 
   else if (ch == '~' && (isalpha(peek()) || peek() == '_' || isdigit(peek()))) 
   {
-    lexeme+= ch;
-    ch = read();
-    while (isalpha(ch) || ch == '_' || isdigit(ch)) 
+    const char* start = pos - 1;
+    ++pos;
+    while (isalpha(peek()) || peek() == '_' || isdigit(peek())) 
     {
-      lexeme += ch;
-      if (isalpha(peek()) || peek() == '_' || isdigit(peek())) 
-      {
-        ch = read();
-        column++;
-      }
-      else 
-        break;
+      ++pos;
+      column++;
     }
+    lexeme.assign(start, pos);
     return Token(POINTER_TYPE, lexeme, line, tempCol);
   }
 
   else if (ch == '&' && (isalpha(peek()) || peek() == '_' || isdigit(peek())))
   {
-    lexeme+= ch;
-    ch = read();
-    while (isalpha(ch) || ch == '_' || isdigit(ch)) 
+    const char* start = pos - 1;
+    ++pos;
+    while (isalpha(peek()) || peek() == '_' || isdigit(peek())) 
     {
-      lexeme += ch;
-      if (isalpha(peek()) || peek() == '_' || isdigit(peek())) 
-      {
-        ch = read();
-        column++;
-      }
-      else 
-        break;
+      ++pos;
+      column++;
     }
+    lexeme.assign(start, pos);
     return Token(POINTER_VAL, lexeme, line, tempCol);
   }
   
@@ -245,20 +324,16 @@ Token Lexer::next_token()
     bool moreDots = false;
     //get numbers and dots
     tempCol = column;
-    while(isdigit(ch) || ch == '.')
+    const char* start = pos - 1;
+    while (isdigit(peek()) || peek() == '.')
     {
-      if (ch == '.')
-      {
-        oneDot = true;
-      }
-      lexeme += ch;
-      //makes sure close comment isn't in output
-      if (isdigit(peek()) || peek() == '.') {
-        ch = read();
-        column++;
-      }
-      else
-        break;
+      ++pos;
+      column++;
+    }
+    lexeme.assign(start, pos);
+    if (lexeme.find('.') != std::string::npos)
+    {
+      oneDot = true;
     }
     //if there is a dot, it is a double
     if (oneDot == true)
@@ -275,25 +350,39 @@ Token Lexer::next_token()
   //if double quote, means it is a string
   else if (ch == '"')
   {
+    const char* start = pos;
     ch = read();
     column++;
-    //keep checking string as long it is not second double quote
+    //keep checking string as long it is not second double quote,
+    //copying runs of plain characters and decoding escapes
     while (ch != '"')
     {
-      lexeme += ch;
+      //if you reach a new line (or the end) without close, should
+      //throw error
+      if (ch == '\n' || ch == EOF)
+        error("Error", line, column);
+      if (ch == '\\')
+      {
+        lexeme.append(start, pos - 1);
+        ch = read();
+        column++;
+        lexeme += escape(ch, line, column);
+        start = pos;
+      }
       ch = read();
       column++;
-      //if you reach a new line without close, should throw error
-      if (ch == '\n')
-        error("Error", line, column);
     }
+    lexeme.append(start, pos - 1);
     return Token(STRING_VAL, lexeme, line, tempCol);
   }
   
   //check for char quote
   else if (ch == '\'')
   {
-    lexeme = read();
+    ch = read();
+    if (ch == '\\')
+      ch = escape(read(), line, tempCol);
+    lexeme = ch;
     //check to make sure it is only one character
     if (peek() != '\'')
     {
@@ -0,0 +1,552 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: optimizer.h
+// DATE: 10/17/2026
+// DESC: Constant folding and propagation over a type-checked MyPL
+//       AST. Operators whose operands are both literals are replaced
+//       by the literal result, and reads of variables that are
+//       initialized to a literal and never written again are replaced
+//       by that literal. Runs after the type checker (it relies on
+//       the slots and kernels set there) and before the interpreter
+//       or compiler.
+//----------------------------------------------------------------------
+
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <climits>
+#include <cmath>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include "ast.h"
+
+
+// collects the slots a function body writes after declaring them:
+// assignment targets, loop variables, and variables whose address is
+// taken (they may be written through the pointer)
+class WrittenSlots : public Visitor
+{
+public:
+
+  WrittenSlots(std::unordered_set<int>& slots);
+
+  // top-level
+  void visit(Program&) {}
+  void visit(FunDecl&) {}
+  void visit(TypeDecl&) {}
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue&) {}
+  void visit(NewRValue&) {}
+  void visit(CallExpr& node);
+  void visit(IDRValue&) {}
+  void visit(NegatedRValue& node);
+  void visit(PointerValue& node);
+  void visit(PointerType&) {}
+
+private:
+
+  std::unordered_set<int>& slots;
+
+  void stmts(Span<Stmt*>& stmt_list);
+};
+
+
+class Optimizer : public Visitor
+{
+public:
+
+  // new literal nodes are allocated from the program's arena
+  Optimizer(ASTArena& arena);
+
+  // top-level
+  void visit(Program& node);
+  void visit(FunDecl& node);
+  void visit(TypeDecl& node);
+  // statements
+  void visit(VarDeclStmt& node);
+  void visit(AssignStmt& node);
+  void visit(ReturnStmt& node);
+  void visit(IfStmt& node);
+  void visit(WhileStmt& node);
+  void visit(ForStmt& node);
+  // expressions
+  void visit(Expr& node);
+  void visit(SimpleTerm& node);
+  void visit(ComplexTerm& node);
+  // rvalues
+  void visit(SimpleRValue& node);
+  void visit(NewRValue& node);
+  void visit(CallExpr& node);
+  void visit(IDRValue& node);
+  void visit(NegatedRValue& node);
+  void visit(PointerValue& node);
+  void visit(PointerType& node);
+
+private:
+
+  ASTArena& arena;
+
+  // the literal the last expression, term, or rvalue visited reduces
+  // to (nullptr if it isn't constant)
+  SimpleRValue* literal = nullptr;
+
+  // within a function: the slots written after their declaration, and
+  // the literal value of each constant variable (by slot)
+  bool propagate = false;
+  std::unordered_set<int> written;
+  std::unordered_map<int,SimpleRValue*> constants;
+
+  void stmts(Span<Stmt*>& stmt_list);
+
+  // a new literal with the given value at the token's position
+  SimpleRValue* make_literal(const DataObject& val, const Token& at);
+
+  // replace the expression with a literal
+  void fold_to(Expr& node, SimpleRValue* value);
+
+  // the literal result of a binary operator on two literals (nullptr
+  // if it can't be computed here, e.g., division by zero, overflow)
+  SimpleRValue* fold(Expr& node, const DataObject& lhs,
+                     const DataObject& rhs);
+};
+
+
+//----------------------------------------------------------------------
+// WrittenSlots
+//----------------------------------------------------------------------
+
+WrittenSlots::WrittenSlots(std::unordered_set<int>& slots)
+  : slots(slots)
+{
+}
+
+void WrittenSlots::stmts(Span<Stmt*>& stmt_list)
+{
+  for (Stmt* s : stmt_list)
+    s->accept(*this);
+}
+
+void WrittenSlots::visit(VarDeclStmt& node)
+{
+  node.expr->accept(*this);
+}
+
+void WrittenSlots::visit(AssignStmt& node)
+{
+  slots.insert(node.slot);
+  node.expr->accept(*this);
+}
+
+void WrittenSlots::visit(ReturnStmt& node)
+{
+  node.expr->accept(*this);
+}
+
+void WrittenSlots::visit(IfStmt& node)
+{
+  node.if_part->expr->accept(*this);
+  stmts(node.if_part->stmts);
+  for (BasicIf* i : node.else_ifs) {
+    i->expr->accept(*this);
+    stmts(i->stmts);
+  }
+  stmts(node.body_stmts);
+}
+
+void WrittenSlots::visit(WhileStmt& node)
+{
+  node.expr->accept(*this);
+  stmts(node.stmts);
+}
+
+void WrittenSlots::visit(ForStmt& node)
+{
+  slots.insert(node.slot);
+  node.start->accept(*this);
+  node.end->accept(*this);
+  stmts(node.stmts);
+}
+
+void WrittenSlots::visit(Expr& node)
+{
+  node.first->accept(*this);
+  if (node.rest)
+    node.rest->accept(*this);
+}
+
+void WrittenSlots::visit(SimpleTerm& node)
+{
+  node.rvalue->accept(*this);
+}
+
+void WrittenSlots::visit(ComplexTerm& node)
+{
+  node.expr->accept(*this);
+}
+
+void WrittenSlots::visit(CallExpr& node)
+{
+  for (Expr* e : node.arg_list)
+    e->accept(*this);
+}
+
+void WrittenSlots::visit(NegatedRValue& node)
+{
+  node.expr->accept(*this);
+}
+
+void WrittenSlots::visit(PointerValue& node)
+{
+  slots.insert(node.slot);
+}
+
+
+//----------------------------------------------------------------------
+// Optimizer
+//----------------------------------------------------------------------
+
+Optimizer::Optimizer(ASTArena& arena)
+  : arena(arena)
+{
+}
+
+void Optimizer::stmts(Span<Stmt*>& stmt_list)
+{
+  for (Stmt* s : stmt_list)
+    s->accept(*this);
+}
+
+// the token is rebuilt from the value (for printing and error
+// positions); the value itself is what gets evaluated
+SimpleRValue* Optimizer::make_literal(const DataObject& val, const Token& at)
+{
+  TokenType type = NIL;
+  std::string lexeme;
+  if (val.is_integer()) {
+    type = INT_VAL;
+    lexeme = val.to_string();
+  }
+  else if (val.is_double()) {
+    type = DOUBLE_VAL;
+    // enough digits to read back the same double
+    double d;
+    val.value(d);
+    std::ostringstream out;
+    out.precision(17);
+    out << d;
+    lexeme = out.str();
+  }
+  else if (val.is_bool()) {
+    type = BOOL_VAL;
+    bool b;
+    val.value(b);
+    lexeme = b ? "true" : "false";
+  }
+  else if (val.is_char()) {
+    type = CHAR_VAL;
+    char c;
+    val.value(c);
+    lexeme = std::string(1, c);
+  }
+  else if (val.is_string()) {
+    type = STRING_VAL;
+    val.value(lexeme);
+  }
+  SimpleRValue* value = arena.make<SimpleRValue>();
+  value->value = Token(type, lexeme, at.line(), at.column());
+  value->val = val;
+  value->decoded = true;
+  return value;
+}
+
+void Optimizer::fold_to(Expr& node, SimpleRValue* value)
+{
+  SimpleTerm* term = arena.make<SimpleTerm>();
+  term->rvalue = value;
+  node.first = term;
+  node.negated = false;
+  node.op = nullptr;
+  node.bin_op = BinOp::NONE;
+  node.kernel = Kernel::GENERIC;
+  node.rest = nullptr;
+  literal = value;
+}
+
+// only operands of the kernel's types are folded, so the result is
+// the one the kernel would compute at run time
+SimpleRValue* Optimizer::fold(Expr& node, const DataObject& lhs,
+                              const DataObject& rhs)
+{
+  Token at = node.first_token();
+  Kernel kernel = node.kernel;
+  if (kernel == Kernel::STRING_CONCAT) {
+    DataObject result = lhs;
+    if (!result.append(rhs))
+      return nullptr;
+    return make_literal(result, at);
+  }
+  if (kernel == Kernel::GENERIC) {
+    bool l_val;
+    bool r_val;
+    if (!lhs.is_bool() or !rhs.is_bool())
+      return nullptr;
+    lhs.value(l_val);
+    rhs.value(r_val);
+    if (node.bin_op == BinOp::AND)
+      return make_literal(DataObject(l_val and r_val), at);
+    if (node.bin_op == BinOp::OR)
+      return make_literal(DataObject(l_val or r_val), at);
+    return nullptr;
+  }
+  if (kernel >= Kernel::DOUBLE_ADD) {
+    double l_val;
+    double r_val;
+    if (!lhs.value(l_val) or !rhs.value(r_val))
+      return nullptr;
+    double result;
+    switch (kernel) {
+      case Kernel::DOUBLE_ADD: result = l_val + r_val; break;
+      case Kernel::DOUBLE_SUB: result = l_val - r_val; break;
+      case Kernel::DOUBLE_MUL: result = l_val * r_val; break;
+      case Kernel::DOUBLE_DIV: result = l_val / r_val; break;
+      case Kernel::DOUBLE_LT: return make_literal(DataObject(l_val < r_val), at);
+      case Kernel::DOUBLE_LE: return make_literal(DataObject(l_val <= r_val), at);
+      case Kernel::DOUBLE_GT: return make_literal(DataObject(l_val > r_val), at);
+      case Kernel::DOUBLE_GE: return make_literal(DataObject(l_val >= r_val), at);
+      default: return nullptr;
+    }
+    if (!std::isfinite(result))
+      return nullptr;
+    return make_literal(DataObject(result), at);
+  }
+  int l_int;
+  int r_int;
+  if (!lhs.value(l_int) or !rhs.value(r_int))
+    return nullptr;
+  long long l_val = l_int;
+  long long r_val = r_int;
+  long long result;
+  switch (kernel) {
+    case Kernel::INT_ADD: result = l_val + r_val; break;
+    case Kernel::INT_SUB: result = l_val - r_val; break;
+    case Kernel::INT_MUL: result = l_val * r_val; break;
+    case Kernel::INT_DIV:
+    case Kernel::INT_MOD:
+      // division errors (and INT_MIN / -1) are left to run time
+      if (r_val == 0 or (l_val == INT_MIN and r_val == -1))
+        return nullptr;
+      result = kernel == Kernel::INT_DIV ? l_val / r_val : l_val % r_val;
+      break;
+    case Kernel::INT_EQ: return make_literal(DataObject(l_val == r_val), at);
+    case Kernel::INT_NE: return make_literal(DataObject(l_val != r_val), at);
+    case Kernel::INT_LT: return make_literal(DataObject(l_val < r_val), at);
+    case Kernel::INT_LE: return make_literal(DataObject(l_val <= r_val), at);
+    case Kernel::INT_GT: return make_literal(DataObject(l_val > r_val), at);
+    case Kernel::INT_GE: return make_literal(DataObject(l_val >= r_val), at);
+    default: return nullptr;
+  }
+  // (as is overflow)
+  if (result < INT_MIN or result > INT_MAX)
+    return nullptr;
+  return make_literal(DataObject(static_cast<int>(result)), at);
+}
+
+
+//----------------------------------------------------------------------
+// top-level
+//----------------------------------------------------------------------
+
+void Optimizer::visit(Program& node)
+{
+  for (Decl* d : node.decls)
+    d->accept(*this);
+}
+
+void Optimizer::visit(FunDecl& node)
+{
+  written.clear();
+  constants.clear();
+  WrittenSlots collector(written);
+  for (Stmt* s : node.stmts)
+    s->accept(collector);
+  propagate = true;
+  stmts(node.stmts);
+  propagate = false;
+}
+
+// fields are written through object paths, so only fold them
+void Optimizer::visit(TypeDecl& node)
+{
+  for (VarDeclStmt* v : node.vdecls)
+    v->accept(*this);
+}
+
+
+//----------------------------------------------------------------------
+// statements
+//----------------------------------------------------------------------
+
+void Optimizer::visit(VarDeclStmt& node)
+{
+  node.expr->accept(*this);
+  if (propagate and literal and !node.pointer and written.count(node.slot) == 0)
+    constants[node.slot] = literal;
+}
+
+void Optimizer::visit(AssignStmt& node)
+{
+  node.expr->accept(*this);
+}
+
+void Optimizer::visit(ReturnStmt& node)
+{
+  node.expr->accept(*this);
+}
+
+void Optimizer::visit(IfStmt& node)
+{
+  node.if_part->expr->accept(*this);
+  stmts(node.if_part->stmts);
+  for (BasicIf* i : node.else_ifs) {
+    i->expr->accept(*this);
+    stmts(i->stmts);
+  }
+  stmts(node.body_stmts);
+}
+
+void Optimizer::visit(WhileStmt& node)
+{
+  node.expr->accept(*this);
+  stmts(node.stmts);
+}
+
+void Optimizer::visit(ForStmt& node)
+{
+  node.start->accept(*this);
+  node.end->accept(*this);
+  stmts(node.stmts);
+}
+
+
+//----------------------------------------------------------------------
+// expressions
+//----------------------------------------------------------------------
+
+void Optimizer::visit(Expr& node)
+{
+  node.first->accept(*this);
+  SimpleRValue* lhs = literal;
+  // a negated expression is its (boolean) first term, inverted
+  if (node.negated) {
+    bool val;
+    if (lhs and lhs->val.is_bool()) {
+      lhs->val.value(val);
+      fold_to(node, make_literal(DataObject(!val), node.first_token()));
+    }
+    else
+      literal = nullptr;
+    return;
+  }
+  if (!node.op) {
+    // drop the parentheses around a folded subexpression
+    if (lhs and dynamic_cast<ComplexTerm*>(node.first))
+      fold_to(node, lhs);
+    return;
+  }
+  node.rest->accept(*this);
+  SimpleRValue* rhs = literal;
+  literal = nullptr;
+  if (lhs and rhs) {
+    SimpleRValue* result = fold(node, lhs->val, rhs->val);
+    if (result)
+      fold_to(node, result);
+  }
+}
+
+void Optimizer::visit(SimpleTerm& node)
+{
+  node.rvalue->accept(*this);
+  if (literal)
+    node.rvalue = literal;
+}
+
+void Optimizer::visit(ComplexTerm& node)
+{
+  node.expr->accept(*this);
+}
+
+
+//----------------------------------------------------------------------
+// rvalues
+//----------------------------------------------------------------------
+
+// nil isn't treated as a constant (it is never folded or propagated),
+// nor is a literal too large to decode
+void Optimizer::visit(SimpleRValue& node)
+{
+  literal = node.decoded and !node.val.is_nil() ? &node : nullptr;
+}
+
+void Optimizer::visit(NewRValue&)
+{
+  literal = nullptr;
+}
+
+void Optimizer::visit(CallExpr& node)
+{
+  for (Expr* e : node.arg_list)
+    e->accept(*this);
+  literal = nullptr;
+}
+
+// a constant variable reads as a copy of its literal (at the read's
+// position, for error messages)
+void Optimizer::visit(IDRValue& node)
+{
+  literal = nullptr;
+  if (!propagate or node.path.size() != 1)
+    return;
+  auto it = constants.find(node.slot);
+  if (it != constants.end())
+    literal = make_literal(it->second->val, node.first_token());
+}
+
+void Optimizer::visit(NegatedRValue& node)
+{
+  node.expr->accept(*this);
+  SimpleRValue* value = literal;
+  literal = nullptr;
+  if (!value)
+    return;
+  int int_val;
+  double double_val;
+  if (value->val.value(int_val) and int_val != INT_MIN)
+    literal = make_literal(DataObject(-int_val), node.first_token());
+  else if (value->val.value(double_val))
+    literal = make_literal(DataObject(-double_val), node.first_token());
+}
+
+void Optimizer::visit(PointerValue&)
+{
+  literal = nullptr;
+}
+
+void Optimizer::visit(PointerType&)
+{
+  literal = nullptr;
+}
+
+
+#endif
@@ -19,15 +19,19 @@ class Parser
 public:
 
   // create a new recursive descent parser
-  Parser(const Lexer& program_lexer);
+  Parser(Lexer& program_lexer);
 
   // run the parser
   void parse(Program& ast_root);
   bool debugFlag = false;
   
 private:
-  Lexer lexer;
+  Lexer& lexer;
   Token curr_token;
+  // where the nodes are allocated (the root's arena)
+  ASTArena* arena = nullptr;
+  // precedence of the operand of neg (above every binary operator)
+  static const int NEG_PREC = 6;
   
   // helper functions
   void advance();
@@ -40,29 +44,30 @@ private:
   void tdecl(TypeDecl& typeDecl);
   void fdecl(FunDecl& funDecl);
   void vdecls(TypeDecl& typeDecl);
-  void params(list<FunDecl::FunParam>& fParams);
+  void params(Span<FunDecl::FunParam>& fParams);
   void dtype(Token& type);
-  void stmts(list<Stmt*>& statements);
+  void stmts(Span<Stmt*>& statements);
   void stmt();
   void vdecl_stmt(VarDeclStmt& varDeclStmt);
   void assign_stmt(AssignStmt& assignStmt);
-  void lvalue(list<Token>& lvalue_lists);
+  void lvalue(Span<Token>& lvalue_lists);
   void cond_stmt(IfStmt& ifStmt);
   void condt(IfStmt& ifStmt);
   void while_stmt(WhileStmt& whileStmt);
   void for_stmt(ForStmt& forStmt);
   void call_expr(CallExpr& callExpr2);
-  void args(list<Expr*>& arg_list);
+  void args(Span<Expr*>& arg_list);
   void exit_stmt(ReturnStmt& returnStmt);
-  void expr(Expr& exprHead);
-  void op(Expr& exprHead);
+  void expr(Expr& exprHead, int min_prec = 0);
+  int precedence(TokenType t);
+  BinOp bin_op(TokenType t);
   void rvalue(SimpleTerm& simpleTerm); 
   void pval(SimpleRValue& simpleRValue);
   void idrval();
 };
 
 // constructor
-Parser::Parser(const Lexer& program_lexer) : lexer(program_lexer)
+Parser::Parser(Lexer& program_lexer) : lexer(program_lexer)
 {
 
 }
@@ -107,19 +112,20 @@ void Parser::debug(std::string msg)
 void Parser::parse(Program& ast_root)
 {
   //cout << "here";
+  arena = &ast_root.arena;
   advance();
   while (curr_token.type() != EOS) {
     //if its a type, we need to create a typedecl object
     if (curr_token.type() == TYPE) {
-      TypeDecl* typeDecl = new TypeDecl();
+      TypeDecl* typeDecl = arena->make<TypeDecl>();
       tdecl(*typeDecl);
-      ast_root.decls.push_back(typeDecl);
+      arena->append(ast_root.decls, typeDecl);
     }
     else {
       //else we now know its a function declaration
-      FunDecl* funDecl = new FunDecl();
+      FunDecl* funDecl = arena->make<FunDecl>();
       fdecl(*funDecl);
-      ast_root.decls.push_back(funDecl);
+      arena->append(ast_root.decls, funDecl);
     }
     //cout << ast_root.decls.size() << " ";
   }
@@ -194,20 +200,20 @@ void Parser::vdecls(TypeDecl& typeDecl)
   while (curr_token.type() == VAR) {
     //basiccaly get the variable declarations
     //and push them into a list
-    VarDeclStmt* varDeclStmt = new VarDeclStmt();
-    typeDecl.vdecls.push_back(varDeclStmt);
+    VarDeclStmt* varDeclStmt = arena->make<VarDeclStmt>();
+    arena->append(typeDecl.vdecls, varDeclStmt);
     vdecl_stmt(*varDeclStmt);
   }
 }
 
 //now check the parameters
-void Parser::params(list<FunDecl::FunParam>& params)
+void Parser::params(Span<FunDecl::FunParam>& params)
 {
   debug("<params>");
   if (curr_token.type() == ID || curr_token.type() == POINTER_TYPE) {
     //create a list that stores the parameters of a function
-    FunDecl::FunParam* funParam = new FunDecl::FunParam();
-    funParam->id = curr_token;
+    FunDecl::FunParam funParam;
+    funParam.id = curr_token;
     if (curr_token.type() == ID) {
       eat(ID, "expecting an ID ");
       eat(COLON, "expecting a ':' ");
@@ -220,63 +226,63 @@ void Parser::params(list<FunDecl::FunParam>& params)
     //a bunch of if statements to check the type
     //also sets the type
     if (curr_token.type() == INT_TYPE) {
-      funParam->type = curr_token;
+      funParam.type = curr_token;
       eat(INT_TYPE, "expecting an int type ");
     }
     else if (curr_token.type() == DOUBLE_TYPE) {
-      funParam->type = curr_token;
+      funParam.type = curr_token;
       eat(DOUBLE_TYPE, "expecting a double type ");
     }
     else if (curr_token.type() == BOOL_TYPE) {
-      funParam->type = curr_token;
+      funParam.type = curr_token;
       eat(BOOL_TYPE, "expecting a bool type ");
     }
     else if (curr_token.type() == CHAR_TYPE) {
-      funParam->type = curr_token;
+      funParam.type = curr_token;
       eat(CHAR_TYPE, "expecting a cahr type ");
     }
     else if (curr_token.type() == STRING_TYPE) {
-      funParam->type = curr_token;
+      funParam.type = curr_token;
       eat(STRING_TYPE, "expecting a string type ");
     }
     else if (curr_token.type() == ID) {
-      funParam->type = curr_token;
+      funParam.type = curr_token;
       eat(ID, "expecting an id ");
     }
     //now push that parameter to the list
     //and more check to get all paramters in the function declaration
-    params.push_back(*funParam);
+    arena->append(params, funParam);
     while (curr_token.type() == COMMA) {
       eat(COMMA, "expecting a comma ");
-      FunDecl::FunParam* funParam2 = new FunDecl::FunParam();
-      funParam2->id = curr_token;
+      FunDecl::FunParam funParam2;
+      funParam2.id = curr_token;
       eat(ID, "expecting an id ");
       eat(COLON, "expecting a colon ");
       if (curr_token.type() == INT_TYPE) {
-        funParam2->type = curr_token;
+        funParam2.type = curr_token;
         eat(INT_TYPE, "expecting an int type ");
       }
       else if (curr_token.type() == DOUBLE_TYPE) {
-        funParam2->type = curr_token;
+        funParam2.type = curr_token;
         eat(DOUBLE_TYPE, "expecting a double type ");
       }
       else if (curr_token.type() == BOOL_TYPE) {
-        funParam2->type = curr_token;
+        funParam2.type = curr_token;
         eat(BOOL_TYPE, "expecting a bool type ");
       }
       else if (curr_token.type() == CHAR_TYPE) {
-        funParam2->type = curr_token;
+        funParam2.type = curr_token;
         eat(CHAR_TYPE, "expecting a cahr type ");
       }
       else if (curr_token.type() == STRING_TYPE) {
-        funParam2->type = curr_token;
+        funParam2.type = curr_token;
         eat(STRING_TYPE, "expecting a string type ");
       }
       else if (curr_token.type() == ID) {
-        funParam2->type = curr_token;
+        funParam2.type = curr_token;
         eat(ID, "expecting an id ");
       }
-      params.push_back(*funParam2);
+      arena->append(params, funParam2);
     }
   }
 }
@@ -313,71 +319,73 @@ void Parser::dtype(Token& type)
   }
 }
 
-//I use stmts to to call itself instead of creating stmt function
-void Parser::stmts(list<Stmt*>& statements)
+//stmts loops over the statements (rather than calling itself per
+//statement) so long bodies don't grow the stack
+void Parser::stmts(Span<Stmt*>& statements)
 { 
   debug("<stmts>");
-  //check all different types of statements we can have in a program
-  if (curr_token.type() == VAR) {
-    //variable declaration statement
-    VarDeclStmt* varDeclStmt = new VarDeclStmt();
-    statements.push_back(varDeclStmt);
-    vdecl_stmt(*varDeclStmt);
-  }
-  else if (curr_token.type() == POINTER_TYPE) {
-      AssignStmt* assignStmt = new AssignStmt();
-      assignStmt->lvalue_list.push_back(curr_token);
-      statements.push_back(assignStmt);
-      eat(POINTER_TYPE, "expecting a pointer type");
-      assign_stmt(*assignStmt);
-  }
-  else if (curr_token.type() == ID) {
-    //id means we need to keep checking to see 
-    //what kind of statement it can be
-    Token temp = curr_token;
-    eat(ID, "expecting an id");
-    if (curr_token.type() == LPAREN) {
-      //now we know its a function call
-      CallExpr* callExpr = new CallExpr();
-      callExpr->function_id = temp;
-      statements.push_back(callExpr);
-      call_expr(*callExpr);
+  while (true) {
+    //check all different types of statements we can have in a program
+    if (curr_token.type() == VAR) {
+      //variable declaration statement
+      VarDeclStmt* varDeclStmt = arena->make<VarDeclStmt>();
+      arena->append(statements, varDeclStmt);
+      vdecl_stmt(*varDeclStmt);
     }
-    else {
-      //now we know its an assignment statement
-      AssignStmt* assignStmt = new AssignStmt();
-      assignStmt->lvalue_list.push_back(temp);
-      statements.push_back(assignStmt);
-      assign_stmt(*assignStmt); 
-    } 
-  }
-  //if statement
-  else if (curr_token.type() == IF) {
-    IfStmt* ifStmt = new IfStmt();
-    statements.push_back(ifStmt); 
-    cond_stmt(*ifStmt);
-  }
-  //while statement
-  else if (curr_token.type() == WHILE) {
-    WhileStmt* whileStmt = new WhileStmt();
-    statements.push_back(whileStmt);
-    while_stmt(*whileStmt);
-  }
-  //for statement
-  else if (curr_token.type() == FOR) {
-    ForStmt* forStmt = new ForStmt();
-    statements.push_back(forStmt);
-    for_stmt(*forStmt);
-  }
-  //return statement
-  else if (curr_token.type() == RETURN) {
-    ReturnStmt* returnStmt = new ReturnStmt();
-    statements.push_back(returnStmt);
-    exit_stmt(*returnStmt);
+    else if (curr_token.type() == POINTER_TYPE) {
+        AssignStmt* assignStmt = arena->make<AssignStmt>();
+        arena->append(assignStmt->lvalue_list, curr_token);
+        arena->append(statements, assignStmt);
+        eat(POINTER_TYPE, "expecting a pointer type");
+        assign_stmt(*assignStmt);
+    }
+    else if (curr_token.type() == ID) {
+      //id means we need to keep checking to see 
+      //what kind of statement it can be
+      Token temp = curr_token;
+      eat(ID, "expecting an id");
+      if (curr_token.type() == LPAREN) {
+        //now we know its a function call
+        CallExpr* callExpr = arena->make<CallExpr>();
+        callExpr->function_id = temp;
+        arena->append(statements, callExpr);
+        call_expr(*callExpr);
+      }
+      else {
+        //now we know its an assignment statement
+        AssignStmt* assignStmt = arena->make<AssignStmt>();
+        arena->append(assignStmt->lvalue_list, temp);
+        arena->append(statements, assignStmt);
+        assign_stmt(*assignStmt); 
+      } 
+    }
+    //if statement
+    else if (curr_token.type() == IF) {
+      IfStmt* ifStmt = arena->make<IfStmt>();
+      arena->append(statements, ifStmt); 
+      cond_stmt(*ifStmt);
+    }
+    //while statement
+    else if (curr_token.type() == WHILE) {
+      WhileStmt* whileStmt = arena->make<WhileStmt>();
+      arena->append(statements, whileStmt);
+      while_stmt(*whileStmt);
+    }
+    //for statement
+    else if (curr_token.type() == FOR) {
+      ForStmt* forStmt = arena->make<ForStmt>();
+      arena->append(statements, forStmt);
+      for_stmt(*forStmt);
+    }
+    //return statement
+    else if (curr_token.type() == RETURN) {
+      ReturnStmt* returnStmt = arena->make<ReturnStmt>();
+      arena->append(statements, returnStmt);
+      exit_stmt(*returnStmt);
+    }
+    else
+      return;
   }
-  else
-    return;
-  stmts(statements);
 }
 
 void Parser::vdecl_stmt(VarDeclStmt& varDeclStmt)
@@ -400,39 +408,39 @@ void Parser::vdecl_stmt(VarDeclStmt& varDeclStmt)
   if (curr_token.type() == COLON) {
     eat(COLON, "expecting a colon ");
     if (curr_token.type() == INT_TYPE) {
-      varDeclStmt.type = new Token(INT_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
+      varDeclStmt.type = arena->make<Token>(INT_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
       //arDeclStmt.type = curr_token.type();
       eat(INT_TYPE, "expecting an int type ");
     }
     else if (curr_token.type() == DOUBLE_TYPE) {
-      varDeclStmt.type = new Token(DOUBLE_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
+      varDeclStmt.type = arena->make<Token>(DOUBLE_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
       //varDeclStmt.type = &curr_token;
       eat(DOUBLE_TYPE, "expecting a double type ");
     }
     else if (curr_token.type() == BOOL_TYPE) {
-      varDeclStmt.type = new Token(BOOL_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
+      varDeclStmt.type = arena->make<Token>(BOOL_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
       //varDeclStmt.type = &curr_token;
       eat(BOOL_TYPE, "expecting a bool type ");
     }
     else if (curr_token.type() == CHAR_TYPE) {
-      varDeclStmt.type = new Token(CHAR_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
+      varDeclStmt.type = arena->make<Token>(CHAR_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
       //varDeclStmt.type = &curr_token;
       eat(CHAR_TYPE, "expecting a cahr type ");
     }
     else if (curr_token.type() == STRING_TYPE) {
-      varDeclStmt.type = new Token(STRING_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
+      varDeclStmt.type = arena->make<Token>(STRING_TYPE, curr_token.lexeme(), curr_token.line(), curr_token.column());
      // varDeclStmt.type = &curr_token;
       eat(STRING_TYPE, "expecting a string type ");
     }
     else if (curr_token.type() == ID) {
-      varDeclStmt.type = new Token(ID, curr_token.lexeme(), curr_token.line(), curr_token.column());
+      varDeclStmt.type = arena->make<Token>(ID, curr_token.lexeme(), curr_token.line(), curr_token.column());
      // varDeclStmt.type = &curr_token;
       eat(ID, "expecting an id here");
     }
   }
   //now create an expr for assignment statement
   eat(ASSIGN, "expecting an assign ");
-  Expr* expr2 = new Expr();
+  Expr* expr2 = arena->make<Expr>();
   varDeclStmt.expr = expr2;
   expr(*expr2);
 }
@@ -445,20 +453,20 @@ void Parser::assign_stmt(AssignStmt& assignStmt)
   lvalue(assignStmt.lvalue_list);
   eat(ASSIGN, "expecting a '=' ");
   //now create an expr for right side
-  Expr* expr2 = new Expr();
+  Expr* expr2 = arena->make<Expr>();
   assignStmt.expr = expr2;
   expr(*expr2);
 }
 
 //get the left value thats being assigned
-void Parser::lvalue(list<Token>& lvalue_lists)
+void Parser::lvalue(Span<Token>& lvalue_lists)
 {
   debug("<lvalue>");
   //getting the left side things
   while (curr_token.type() == DOT) {
     eat(DOT, "expecting a dot ");
     //push them to the list
-    lvalue_lists.push_back(curr_token);
+    arena->append(lvalue_lists, curr_token);
     eat(ID, "expecting an id ");
   }
 }
@@ -468,10 +476,10 @@ void Parser::cond_stmt(IfStmt& ifStmt)
 {
   debug("<cond_stmt>");
   //creat the basif if part
-  BasicIf* basicIf = new BasicIf;
+  BasicIf* basicIf = arena->make<BasicIf>();
   ifStmt.if_part = basicIf;
   //now the expr for that if
-  Expr* expr2 = new Expr();
+  Expr* expr2 = arena->make<Expr>();
   basicIf->expr = expr2;
   eat(IF, "expecting an if ");
   expr(*expr2);
@@ -487,10 +495,10 @@ void Parser::condt(IfStmt& ifStmt)
   debug("<condt>");
   //now check for the esle if in an if statement
   if (curr_token.type() == ELSEIF) {
-    BasicIf* basicIf = new BasicIf();
-    Expr* expr2 = new Expr();
+    BasicIf* basicIf = arena->make<BasicIf>();
+    Expr* expr2 = arena->make<Expr>();
     basicIf->expr = expr2;
-    ifStmt.else_ifs.push_back(basicIf);
+    arena->append(ifStmt.else_ifs, basicIf);
     //eat(ELSEIF, "expecting an else if ");
     advance();
     expr(*expr2);
@@ -511,7 +519,7 @@ void Parser::while_stmt(WhileStmt& whileStmt)
   debug("<while_stmt>");
   //now check the while statement
   eat(WHILE, "expecting a while ");
-  Expr* expr2 = new Expr();
+  Expr* expr2 = arena->make<Expr>();
   whileStmt.expr = expr2;
   expr(*expr2);
   eat(DO, "expecting a do ");
@@ -528,11 +536,11 @@ void Parser::for_stmt(ForStmt& forStmt)
   forStmt.var_id = curr_token;
   eat(ID, "expecting an id ");
   eat(ASSIGN, "expecting a '=' ");
-  Expr* startEx = new Expr();
+  Expr* startEx = arena->make<Expr>();
   forStmt.start = startEx;
   expr(*startEx);
   eat(TO, "expecting a to ");
-  Expr* endEx = new Expr();
+  Expr* endEx = arena->make<Expr>();
   forStmt.end = endEx;
   expr(*endEx);
   eat(DO, "expecting a do ");
@@ -551,28 +559,28 @@ void Parser::call_expr(CallExpr& callExpr2)
 }
 
 //check for arguments in a function
-void Parser::args(list<Expr*>& arg_list)
+void Parser::args(Span<Expr*>& arg_list)
 {
   if (curr_token.type() == NOT) {
-    Expr* expr2 = new Expr();
-    arg_list.push_back(expr2);
+    Expr* expr2 = arena->make<Expr>();
+    arena->append(arg_list, expr2);
     expr(*expr2);
     while (curr_token.type() == COMMA) {
       eat(COMMA, "expecting a comma ");
-      Expr* exprRec = new Expr();
-      arg_list.push_back(exprRec);
+      Expr* exprRec = arena->make<Expr>();
+      arena->append(arg_list, exprRec);
       expr(*exprRec);
     }
   }
   //expr need parens
   else if (curr_token.type() == LPAREN) {
-    Expr* expr2 = new Expr();
-    arg_list.push_back(expr2);
+    Expr* expr2 = arena->make<Expr>();
+    arena->append(arg_list, expr2);
     expr(*expr2);
     while (curr_token.type() == COMMA) {
       eat(COMMA, "expecting a comma ");
-      Expr* exprRec = new Expr();
-      arg_list.push_back(exprRec);
+      Expr* exprRec = arena->make<Expr>();
+      arena->append(arg_list, exprRec);
       expr(*exprRec);
     }
   }
@@ -583,13 +591,13 @@ void Parser::args(list<Expr*>& arg_list)
            curr_token.type() == BOOL_VAL || curr_token.type() == CHAR_VAL ||
            curr_token.type() == STRING_VAL || curr_token.type() == POINTER_VAL
            || curr_token.type() == POINTER_TYPE) {
-    Expr* expr2 = new Expr();
-    arg_list.push_back(expr2);
+    Expr* expr2 = arena->make<Expr>();
+    arena->append(arg_list, expr2);
     expr(*expr2);
     while (curr_token.type() == COMMA) {
       eat(COMMA, "expecting a comma ");
-      Expr* exprRec = new Expr();
-      arg_list.push_back(exprRec);
+      Expr* exprRec = arena->make<Expr>();
+      arena->append(arg_list, exprRec);
       expr(*exprRec);
     }
   }
@@ -615,30 +623,35 @@ void Parser::exit_stmt(ReturnStmt& returnStmt)
   debug("<exit_stmt>");
   //return statement that create an expr
   eat(RETURN, "expecting a return "); 
-  Expr* expr2 = new Expr();
+  Expr* expr2 = arena->make<Expr>();
   returnStmt.expr = expr2;
   expr(*expr2);
 }
 
-void Parser::expr(Expr& exprHead)
+//expressions are parsed by precedence climbing: each operator binds
+//by its precedence, and operators of equal precedence group to the
+//left, so an Expr with an operator is a single binary operation
+void Parser::expr(Expr& exprHead, int min_prec)
 {
   debug("<expr>");
   //now we need to check the kind of expression we have
+  //(not applies to the whole expression after it)
   if (curr_token.type() == NOT) {
     exprHead.negated = true;
     eat(NOT, "expecting a '!' ");
-    ComplexTerm* complexTerm = new ComplexTerm();
+    ComplexTerm* complexTerm = arena->make<ComplexTerm>();
     exprHead.first = complexTerm;
-    Expr* expr2 = new Expr();
+    Expr* expr2 = arena->make<Expr>();
     complexTerm->expr = expr2;
     expr(*expr2);
+    return;
   }
   //expr need parens
   else if (curr_token.type() == LPAREN) {
     eat(LPAREN, "expecting a '(' ");
-    ComplexTerm* complexTerm = new ComplexTerm();
+    ComplexTerm* complexTerm = arena->make<ComplexTerm>();
     exprHead.first = complexTerm;
-    Expr* expr2 = new Expr();
+    Expr* expr2 = arena->make<Expr>();
     complexTerm->expr = expr2;
     expr(*expr2);
     eat(RPAREN, "expecting a ')' ");
@@ -649,96 +662,72 @@ void Parser::expr(Expr& exprHead)
            curr_token.type() == INT_VAL ||curr_token.type() == DOUBLE_VAL ||
            curr_token.type() == BOOL_VAL || curr_token.type() == CHAR_VAL ||
            curr_token.type() == STRING_VAL || curr_token.type() == POINTER_TYPE) {
-    SimpleTerm* simpleTerm = new SimpleTerm();
+    SimpleTerm* simpleTerm = arena->make<SimpleTerm>();
     exprHead.first = simpleTerm;
     rvalue(*simpleTerm);
   }
   else if (curr_token.type() == POINTER_VAL) {
-    SimpleTerm* simpleTerm = new SimpleTerm();
+    SimpleTerm* simpleTerm = arena->make<SimpleTerm>();
     exprHead.first = simpleTerm;
     rvalue(*simpleTerm);
   }
-  //get operator
-  op(exprHead);
+  //get each operator that binds at least as tightly as min_prec
+  while (precedence(curr_token.type()) >= min_prec) {
+    int prec = precedence(curr_token.type());
+    //the operation so far becomes the left operand
+    if (exprHead.op != nullptr) {
+      Expr* left = arena->make<Expr>();
+      left->first = exprHead.first;
+      left->op = exprHead.op;
+      left->bin_op = exprHead.bin_op;
+      left->rest = exprHead.rest;
+      ComplexTerm* complexTerm = arena->make<ComplexTerm>();
+      complexTerm->expr = left;
+      exprHead.first = complexTerm;
+    }
+    exprHead.op = arena->make<Token>(curr_token);
+    exprHead.bin_op = bin_op(curr_token.type());
+    advance();
+    //get the right operand (only tighter operators group into it)
+    Expr* exprRest = arena->make<Expr>();
+    exprHead.rest = exprRest;
+    expr(*exprRest, prec + 1);
+  }
 }
 
-//check for all different operations
-void Parser::op(Expr& exprHead) 
+//binding strength of a binary operator (-1 if not an operator)
+int Parser::precedence(TokenType t)
 {
-  debug("<op>");
-  //we need to get the operator
-  //inoder to do so, we have to create a new token of that operator
-  if (curr_token.type() == PLUS) {
-    exprHead.op = new Token(PLUS, curr_token.lexeme(), curr_token.line(), curr_token.column());
-    //exprHead.op = &curr_token;
-    eat(PLUS, "expecting a '+' ");
-  }
-  else if (curr_token.type() == MINUS) {
-    exprHead.op = new Token(MINUS, curr_token.lexeme(), curr_token.line(), curr_token.column());
-    //exprHead.op = &curr_token;
-    eat(MINUS, "expecting a '-' ");
-  }
-  else if (curr_token.type() == DIVIDE) {
-    exprHead.op = new Token(DIVIDE, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(DIVIDE, "expecting a '/' ");
-  }
-  else if (curr_token.type() == MULTIPLY) {
-    exprHead.op = new Token(MULTIPLY, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(MULTIPLY, "expecting a '*' ");
-  }
-  else if (curr_token.type() == MODULO) {
-    exprHead.op = new Token(MODULO, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(MODULO, "expecting a '%' ");
-  }
-  else if (curr_token.type() == AND) { 
-    exprHead.op = new Token(AND, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(AND, "expecting a '&&' ");
-  }
-  else if (curr_token.type() == OR) { 
-    exprHead.op = new Token(OR, curr_token.lexeme(), curr_token.line(), curr_token.column());
-    //exprHead.op = &curr_token;
-    eat(OR, "expecting a '||' ");
-  }
-  else if (curr_token.type() == EQUAL) { 
-    exprHead.op = new Token(EQUAL, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(EQUAL, "expecting a '==' ");
-  }
-  else if (curr_token.type() == LESS) { 
-    exprHead.op = new Token(LESS, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(LESS, "expecting a '<' ");
-  }
-  else if (curr_token.type() == GREATER) { 
-    exprHead.op = new Token(GREATER, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(GREATER, "expecting a '>' ");
-  }
-  else if (curr_token.type() == LESS_EQUAL) { 
-    exprHead.op = new Token(LESS_EQUAL, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(LESS_EQUAL, "expecting a '<=' ");
-  }
-  else if (curr_token.type() == GREATER_EQUAL) { 
-    exprHead.op = new Token(GREATER_EQUAL, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(GREATER_EQUAL, "expecting a '>=' ");
-  }
-  else if (curr_token.type() == NOT_EQUAL) { 
-    exprHead.op = new Token(NOT_EQUAL, curr_token.lexeme(), curr_token.line(), curr_token.column());
-   // exprHead.op = &curr_token;
-    eat(NOT_EQUAL, "expecting a '!=' ");
-  }
-  else 
-    return;
-  //get the expression after the operator
-  Expr* exprRest = new Expr();
-  exprHead.rest = exprRest;
-  expr(*exprRest);
+  switch (t) {
+    case OR: return 1;
+    case AND: return 2;
+    case EQUAL: case NOT_EQUAL: case LESS: case LESS_EQUAL:
+    case GREATER: case GREATER_EQUAL: return 3;
+    case PLUS: case MINUS: return 4;
+    case MULTIPLY: case DIVIDE: case MODULO: return 5;
+    default: return -1;
+  }
+}
+
+//the operation an operator token denotes
+BinOp Parser::bin_op(TokenType t)
+{
+  switch (t) {
+    case PLUS: return BinOp::ADD;
+    case MINUS: return BinOp::SUB;
+    case MULTIPLY: return BinOp::MUL;
+    case DIVIDE: return BinOp::DIV;
+    case MODULO: return BinOp::MOD;
+    case AND: return BinOp::AND;
+    case OR: return BinOp::OR;
+    case EQUAL: return BinOp::EQ;
+    case NOT_EQUAL: return BinOp::NE;
+    case LESS: return BinOp::LT;
+    case LESS_EQUAL: return BinOp::LE;
+    case GREATER: return BinOp::GT;
+    case GREATER_EQUAL: return BinOp::GE;
+    default: return BinOp::NONE;
+  }
 }
 
 //these are values that are being assigned to lvalues
@@ -748,7 +737,7 @@ void Parser::rvalue(SimpleTerm& simpleTerm)
   //we need to find the simple rvalue
   //nil value
   if (curr_token.type() == NIL) {
-    SimpleRValue* simpleRValue = new SimpleRValue();
+    SimpleRValue* simpleRValue = arena->make<SimpleRValue>();
     simpleRValue->value = curr_token;
     simpleTerm.rvalue = simpleRValue;
     eat(NIL, "expecting a nil ");
@@ -756,7 +745,7 @@ void Parser::rvalue(SimpleTerm& simpleTerm)
   //this is a new value
   else if (curr_token.type() == NEW) {
     eat(NEW, "expecting a new ");
-    NewRValue* newRValue = new NewRValue();
+    NewRValue* newRValue = arena->make<NewRValue>();
     newRValue->type_id = curr_token;
     simpleTerm.rvalue = newRValue;
     eat(ID, "expecting an id ");
@@ -766,18 +755,18 @@ void Parser::rvalue(SimpleTerm& simpleTerm)
     Token temp = curr_token;
     eat(ID, "expecting an id ");
     if (curr_token.type() == LPAREN) {
-      CallExpr* callExpr2 = new CallExpr();
+      CallExpr* callExpr2 = arena->make<CallExpr>();
       //callExpr.arg_list.push_back(temp);
       callExpr2->function_id = temp;
       simpleTerm.rvalue = callExpr2;
       call_expr(*callExpr2);
     }
     else {
-      IDRValue* idrValue = new IDRValue();
-      idrValue->path.push_back(temp);
+      IDRValue* idrValue = arena->make<IDRValue>();
+      arena->append(idrValue->path, temp);
       while (curr_token.type() == DOT) {
         eat(DOT, "expecting a dot ");
-        idrValue->path.push_back(curr_token);
+        arena->append(idrValue->path, curr_token);
         eat(ID, "expecting an id ");
       }
       simpleTerm.rvalue = idrValue;
@@ -786,26 +775,27 @@ void Parser::rvalue(SimpleTerm& simpleTerm)
   //negate a value
   else if (curr_token.type() == NEG) {
     eat(NEG, "expecting a neg ");
-    NegatedRValue* negatedRValue = new NegatedRValue();
-    Expr* exprNeg = new Expr();
+    NegatedRValue* negatedRValue = arena->make<NegatedRValue>();
+    Expr* exprNeg = arena->make<Expr>();
     negatedRValue->expr = exprNeg;
     simpleTerm.rvalue = negatedRValue;
-    expr(*exprNeg);
+    //neg binds tighter than any binary operator
+    expr(*exprNeg, NEG_PREC);
   }
   else if (curr_token.type() == POINTER_VAL) {
-    PointerValue* pointerValue = new PointerValue();
+    PointerValue* pointerValue = arena->make<PointerValue>();
     pointerValue->pointer = curr_token;
     simpleTerm.rvalue = pointerValue;
     eat(POINTER_VAL, "expecting a pointer val ");
   }
   else if (curr_token.type() == POINTER_TYPE) {
-    PointerType* pointerType = new PointerType();
+    PointerType* pointerType = arena->make<PointerType>();
     pointerType->pointer = curr_token;
     simpleTerm.rvalue = pointerType;
     eat(POINTER_TYPE, "expecting a pointer type ");
   }
   else { 
-    SimpleRValue* simpleRValue = new SimpleRValue();
+    SimpleRValue* simpleRValue = arena->make<SimpleRValue>();
     pval(*simpleRValue);
     simpleTerm.rvalue = simpleRValue;
   }
@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: peephole.h
+// DATE: 10/17/2026
+// DESC: Peephole pass over compiled MyPL bytecode. The instruction
+//       sequences behind the most common statement shapes (i = i + 1,
+//       n - 1, reading or writing x.f for a local x, and an int
+//       comparison feeding a branch) are replaced by single
+//       superinstructions, and the number of rewrites of each kind is
+//       kept for a report. Runs after the compiler and before the VM.
+//----------------------------------------------------------------------
+
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <cstdio>
+#include <ostream>
+#include <vector>
+#include "bytecode.h"
+
+
+class Peephole
+{
+public:
+
+  //----------------------------------------------------------------------
+  // Fuse the instructions of each code object in a program.
+  // Inputs:
+  //   program -- the compiled program (rewritten in place)
+  //----------------------------------------------------------------------
+  void run(Bytecode& program);
+
+  //----------------------------------------------------------------------
+  // Write the number of times each superinstruction was made and the
+  // number of instructions removed.
+  // Inputs:
+  //   out -- the stream to write to
+  //----------------------------------------------------------------------
+  void report(std::ostream& out) const;
+
+private:
+
+  // rewrites made, by superinstruction opcode
+  std::vector<size_t> fired = std::vector<size_t>(OP_READ + 1, 0);
+
+  // instructions removed by the rewrites
+  size_t removed = 0;
+
+  void run(CodeObject& code);
+
+  // the value of an int constant instruction (false if not one)
+  bool int_const(const CodeObject& code, const Instr& instr,
+                 int& val) const;
+};
+
+
+void Peephole::run(Bytecode& program)
+{
+  for (CodeObject& code : program.functions)
+    run(code);
+}
+
+
+bool Peephole::int_const(const CodeObject& code, const Instr& instr,
+                         int& val) const
+{
+  return instr.op == OP_CONST and code.consts[instr.arg].value(val);
+}
+
+
+void Peephole::run(CodeObject& code)
+{
+  const std::vector<Instr>& in = code.instrs;
+  size_t n = in.size();
+  // a jump may only land on the first instruction of a sequence
+  std::vector<bool> target(n + 1, false);
+  for (const Instr& instr : in)
+    if (is_jump(instr.op))
+      target[instr.arg] = true;
+  auto fits = [&](size_t i, size_t len) {
+    if (i + len > n)
+      return false;
+    for (size_t j = i + 1; j < i + len; ++j)
+      if (target[j])
+        return false;
+    return true;
+  };
+  auto int_cmp = [](OpCode op) {
+    return op == OP_EQ_INT or op == OP_NE_INT or op == OP_LT_INT or
+      op == OP_LE_INT or op == OP_GT_INT or op == OP_GE_INT;
+  };
+
+  std::vector<Instr> out;
+  std::vector<int> lines;
+  std::vector<int> columns;
+  // the new index of each old instruction (and of the end)
+  std::vector<int> moved(n + 1);
+  size_t i = 0;
+  while (i < n) {
+    Instr fused = in[i];
+    size_t len = 1;
+    size_t at = i;          // the instruction whose errors it reports
+    int k = 0;
+    // i = i + k, i = i - k
+    if (fits(i, 4) and in[i].op == OP_LOAD and int_const(code, in[i+1], k)
+        and (in[i+2].op == OP_ADD_INT or in[i+2].op == OP_SUB_INT)
+        and in[i+3].op == OP_STORE and in[i+3].arg == in[i].arg) {
+      OpCode op = in[i+2].op == OP_ADD_INT ? OP_INC_LOCAL : OP_DEC_LOCAL;
+      fused = Instr{op, in[i].arg, k};
+      len = 4;
+      at = i + 2;
+    }
+    // n + k, n - k
+    else if (fits(i, 3) and in[i].op == OP_LOAD and
+             int_const(code, in[i+1], k) and
+             (in[i+2].op == OP_ADD_INT or in[i+2].op == OP_SUB_INT)) {
+      OpCode op = in[i+2].op == OP_ADD_INT ? OP_LOAD_ADD_CONST
+        : OP_LOAD_SUB_CONST;
+      fused = Instr{op, in[i].arg, k};
+      len = 3;
+      at = i + 2;
+    }
+    // x.f read or written
+    else if (fits(i, 2) and in[i].op == OP_LOAD and
+             (in[i+1].op == OP_GET_FIELD or in[i+1].op == OP_SET_FIELD)) {
+      OpCode op = in[i+1].op == OP_GET_FIELD ? OP_LOAD_FIELD
+        : OP_STORE_FIELD;
+      fused = Instr{op, in[i].arg, in[i+1].arg};
+      len = 2;
+      at = i + 1;
+    }
+    // if a < b then, while a < b do
+    else if (fits(i, 2) and int_cmp(in[i].op) and
+             in[i+1].op == OP_JUMP_IF_FALSE) {
+      fused = Instr{OP_CMP_JUMP_INT, in[i+1].arg, in[i].op};
+      len = 2;
+    }
+    if (len > 1) {
+      ++fired[fused.op];
+      removed += len - 1;
+    }
+    for (size_t j = i; j < i + len; ++j)
+      moved[j] = out.size();
+    out.push_back(fused);
+    lines.push_back(code.lines[at]);
+    columns.push_back(code.columns[at]);
+    i += len;
+  }
+  moved[n] = out.size();
+  for (Instr& instr : out)
+    if (is_jump(instr.op))
+      instr.arg = moved[instr.arg];
+  code.instrs = std::move(out);
+  code.lines = std::move(lines);
+  code.columns = std::move(columns);
+}
+
+
+void Peephole::report(std::ostream& out) const
+{
+  static const struct {OpCode op; const char* name;} ops[] = {
+    {OP_INC_LOCAL, "inc-local"},
+    {OP_DEC_LOCAL, "dec-local"},
+    {OP_LOAD_ADD_CONST, "load-add-const"},
+    {OP_LOAD_SUB_CONST, "load-sub-const"},
+    {OP_LOAD_FIELD, "load-field"},
+    {OP_STORE_FIELD, "store-field"},
+    {OP_CMP_JUMP_INT, "cmp-jump-int"},
+  };
+  char line[80];
+  for (const auto& entry : ops) {
+    snprintf(line, sizeof(line), "%-22s %8zu", entry.name, fired[entry.op]);
+    out << line << std::endl;
+  }
+  snprintf(line, sizeof(line), "%-22s %8zu", "instructions removed",
+           removed);
+  out << line << std::endl;
+}
+
+
+#endif
@@ -46,6 +46,7 @@ private:
   void inc_indent() {indent += 3;}
   void dec_indent() {indent -= 3;}
   std::string get_indent() {return std::string(indent, ' ');}
+  std::string escape(const std::string& str);
 
 };
 
@@ -268,16 +269,40 @@ private:
     }
   }
 
+  //literal values were decoded by the lexer, so put the escape
+  //sequences back
+  std::string Printer::escape(const std::string& str)
+  {
+    std::string result;
+    for (char ch : str) {
+      switch (ch) {
+        case '\n': result += "\\n"; break;
+        case '\t': result += "\\t"; break;
+        case '\r': result += "\\r"; break;
+        case '\0': result += "\\0"; break;
+        case '\a': result += "\\a"; break;
+        case '\b': result += "\\b"; break;
+        case '\f': result += "\\f"; break;
+        case '\v': result += "\\v"; break;
+        case '\\': result += "\\\\"; break;
+        case '"': result += "\\\""; break;
+        case '\'': result += "\\'"; break;
+        default: result += ch;
+      }
+    }
+    return result;
+  }
+
   // rvalues
   void Printer::visit(SimpleRValue& node)
   {
     //output the simple r values
     //special case for strings
     if (node.value.type() == STRING_VAL) {
-      std::cout << "\"" << node.value.lexeme() << "\"";
+      std::cout << "\"" << escape(node.value.lexeme()) << "\"";
     }
     else if (node.value.type() == CHAR_VAL) {
-      std::cout << "\'" << node.value.lexeme() << "\'";
+      std::cout << "\'" << escape(node.value.lexeme()) << "\'";
     }
     else
       std::cout << node.value.lexeme(); 
@@ -0,0 +1,151 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: profiler.h
+// DATE: 10/17/2026
+// DESC: Function-level profiler for MyPL programs. The interpreter
+//       (or VM) reports each user function call and return and each
+//       object allocation, and the profiler keeps per-function call
+//       counts, inclusive and exclusive time, and allocations.
+//----------------------------------------------------------------------
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+class Profiler
+{
+public:
+
+  //----------------------------------------------------------------------
+  // Record the start of a call.
+  // Inputs:
+  //   fun_name -- the function being called
+  //----------------------------------------------------------------------
+  void enter(const std::string& fun_name);
+
+  //----------------------------------------------------------------------
+  // Record the return from the most recently entered call.
+  //----------------------------------------------------------------------
+  void exit();
+
+  //----------------------------------------------------------------------
+  // Record an object allocation by the currently running function.
+  //----------------------------------------------------------------------
+  void count_alloc();
+
+  //----------------------------------------------------------------------
+  // Write the report, one line per function, sorted by exclusive time.
+  // Inputs:
+  //   out -- the stream to write to
+  //----------------------------------------------------------------------
+  void report(std::ostream& out) const;
+
+private:
+
+  using Clock = std::chrono::steady_clock;
+
+  // totals for one function
+  struct FunStats {
+    std::string name;
+    size_t calls = 0;
+    double inclusive_ms = 0.0;   // counted once for recursive calls
+    double exclusive_ms = 0.0;   // time not spent in callees
+    size_t self_allocs = 0;      // allocations in the function itself
+    size_t total_allocs = 0;     // including callees
+    int active = 0;              // calls currently on the stack
+  };
+
+  // an active call
+  struct Call {
+    FunStats* stats;
+    Clock::time_point start;
+    double callee_ms;            // inclusive time of direct callees
+    size_t allocs;               // allocations including callees
+  };
+
+  // the stats of each function (map nodes never move, so the call
+  // stack can point into it)
+  std::unordered_map<std::string,FunStats> functions;
+
+  // the active calls
+  std::vector<Call> calls;
+};
+
+
+void Profiler::enter(const std::string& fun_name)
+{
+  FunStats& stats = functions[fun_name];
+  stats.name = fun_name;
+  ++stats.calls;
+  ++stats.active;
+  calls.push_back(Call{&stats, Clock::now(), 0.0, 0});
+}
+
+
+void Profiler::exit()
+{
+  if (calls.empty())
+    return;
+  Call call = calls.back();
+  calls.pop_back();
+  std::chrono::duration<double,std::milli> elapsed = Clock::now() - call.start;
+  FunStats& stats = *call.stats;
+  --stats.active;
+  stats.exclusive_ms += elapsed.count() - call.callee_ms;
+  // a recursive call's time is already inside the outermost call's
+  if (stats.active == 0) {
+    stats.inclusive_ms += elapsed.count();
+    stats.total_allocs += call.allocs;
+  }
+  if (!calls.empty()) {
+    calls.back().callee_ms += elapsed.count();
+    calls.back().allocs += call.allocs;
+  }
+}
+
+
+void Profiler::count_alloc()
+{
+  if (calls.empty())
+    return;
+  ++calls.back().stats->self_allocs;
+  ++calls.back().allocs;
+}
+
+
+void Profiler::report(std::ostream& out) const
+{
+  std::vector<const FunStats*> sorted;
+  double total_ms = 0.0;
+  for (const auto& f : functions) {
+    sorted.push_back(&f.second);
+    total_ms += f.second.exclusive_ms;
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const FunStats* a, const FunStats* b) {
+              return a->exclusive_ms > b->exclusive_ms;
+            });
+  char line[160];
+  snprintf(line, sizeof(line), "%-20s %10s %12s %12s %7s %12s %12s",
+           "function", "calls", "incl ms", "excl ms", "excl %",
+           "self allocs", "incl allocs");
+  out << line << std::endl;
+  for (const FunStats* f : sorted) {
+    double percent = total_ms > 0.0 ? 100.0 * f->exclusive_ms / total_ms : 0.0;
+    snprintf(line, sizeof(line), "%-20s %10zu %12.3f %12.3f %6.1f%% %12zu %12zu",
+             f->name.c_str(), f->calls, f->inclusive_ms, f->exclusive_ms,
+             percent, f->self_allocs, f->total_allocs);
+    out << line << std::endl;
+  }
+}
+
+
+#endif
@@ -3,14 +3,15 @@
 //CLASS: CPSC326 
 // FILE: token.h
 // DATE: Spring 2021
-// DESC: Token representation for MyPL. 
+// DESC: Token representation for MyPL. Lexemes are interned, so a
+//       token is a type, a symbol id, and a location.
 //----------------------------------------------------------------------
 
 #ifndef TOKEN_H
 #define TOKEN_H
 
 #include <string>
-#include <map>
+#include "interner.h"
 
 
 // MyPL allowable token types
@@ -46,11 +47,18 @@ public:
   // constructor
   Token(TokenType type, const std::string& lexeme, int line, int column);
 
+  // constructor (from an already interned lexeme)
+  Token(TokenType type, Symbol symbol, int line, int column);
+
   // return the type of the token
   TokenType type() const;
 
   // return the token string value
-  std::string lexeme() const;
+  const std::string& lexeme() const;
+
+  // return the interned id of the token string value (equal lexemes
+  // have equal ids)
+  Symbol symbol() const;
 
   // return the line location of lexeme
   int line() const;
@@ -60,69 +68,41 @@ public:
 
   // a string representation of the token object
   std::string to_string() const;
+
+  // the name of a token type (for printing)
+  static const char* type_name(TokenType type);
   
 private:
 
   // the type of the token 
   TokenType token_type;
 
-  // the token's value in the program
-  std::string token_lexeme;
+  // the token's value in the program (interned)
+  Symbol token_symbol;
 
   // the line location of the lexeme (starts at 1)
   int token_line;
 
   // the column location of the start of the lexeme (starts at 1)
   int token_column;
-
-  // token type to string representation (for printing)
-  std::map<TokenType,std::string> token_type_map =
-    { 
-      // basic symbols
-      // *** TODO *** 
-      {ASSIGN, "ASSIGN"}, {COMMA, "COMMA"}, {DOT, "DOT"},
-      {LPAREN, "LPAREN"}, {RPAREN, "RPAREN"}, {COLON, "COLON"},
-
-      // math operators
-      {PLUS, "PLUS"}, {MINUS, "MINUS"}, {MULTIPLY, "MULTIPLY"},
-      {DIVIDE, "DIVIDE"}, {MODULO, "MODULO"}, {NEG, "NEG"},
-      {STRING_VAL, "STRING_VAL"},
-      // logical operators
-      {AND, "AND"}, {OR, "OR"}, {NOT, "NOT"},
-      // comparators
-      {EQUAL, "EQUAL"}, {GREATER, "GREATER"},
-      {GREATER_EQUAL, "GREATER_EQUAL"}, {LESS, "LESS"},
-      {LESS_EQUAL, "LESS_EQUAL"}, {NOT_EQUAL, "NOT_EQUAL"},
-      
-      // reserved words
-      // *** TODO ***
-      {TYPE, "TYPE"}, {WHILE, "WHILE"}, {FOR, "FOR"}, {TO, "TO"},
-      {DO, "DO"}, {IF, "IF"}, {THEN, "THEN"}, {ELSEIF, "ELSEIF"},
-      {ELSE, "ELSE"}, {END, "END"}, {FUN, "FUN"}, {VAR, "VAR"},
-      {RETURN, "RETURN"}, {NEW, "NEW"},
-
-      // primitive types
-      {BOOL_TYPE, "BOOL_TYPE"}, {INT_TYPE, "INT_TYPE"},
-      {DOUBLE_TYPE, "DOUBLE_TYPE"}, {CHAR_TYPE, "CHAR_TYPE"},
-      {STRING_TYPE, "STRING_TYPE"}, {POINTER_TYPE, "POINTER_TYPE"},
-      // values
-      {BOOL_VAL, "BOOL_VAL"}, {INT_VAL, "INT_VAL"},
-      {DOUBLE_VAL, "DOUBLE_VAL"}, {STRING_VAL, "STRING_VAL"},
-      {CHAR_VAL, "CHAR_VAL"}, {POINTER_VAL, "POINTER_VAL"}, {ID, "ID"}, {NIL, "NIL"},
-      // eos
-      {EOS, "EOS"}
-    };
 };
 
 
 Token::Token()
-  : token_type(EOS), token_lexeme(""), token_line(0), token_column(0)
+  : token_type(EOS), token_symbol(0), token_line(0), token_column(0)
 {
 }
 
 
 Token::Token(TokenType type, const std::string& lexeme, int line, int column)
-  : token_type(type), token_lexeme(lexeme), token_line(line),
+  : token_type(type), token_symbol(Interner::intern(lexeme)), token_line(line),
+    token_column(column)
+{
+}
+
+
+Token::Token(TokenType type, Symbol symbol, int line, int column)
+  : token_type(type), token_symbol(symbol), token_line(line),
     token_column(column)
 {
 }
@@ -134,9 +114,15 @@ TokenType Token::type() const
 }
 
 
-std::string Token::lexeme() const
+const std::string& Token::lexeme() const
 {
-  return token_lexeme;
+  return Interner::name(token_symbol);
+}
+
+
+Symbol Token::symbol() const
+{
+  return token_symbol;
 }
 
 
@@ -152,9 +138,39 @@ int Token::column() const
 }
 
 
+const char* Token::type_name(TokenType type)
+{
+  // token type to string representation, in TokenType order
+  static const char* const names[] = {
+    // basic symbols
+    "ASSIGN", "COMMA", "DOT", "LPAREN", "RPAREN", "COLON",
+    // math operators
+    "PLUS", "MINUS", "MULTIPLY", "DIVIDE", "MODULO", "NEG",
+    // logical operators
+    "AND", "OR", "NOT",
+    // comparators
+    "EQUAL", "GREATER", "GREATER_EQUAL", "LESS", "LESS_EQUAL", "NOT_EQUAL",
+    // reserved words
+    "TYPE", "WHILE", "FOR", "TO", "DO", "IF", "THEN", "ELSEIF", "ELSE",
+    "END", "FUN", "VAR", "RETURN", "NEW",
+    // primitive types
+    "BOOL_TYPE", "INT_TYPE", "DOUBLE_TYPE", "CHAR_TYPE", "STRING_TYPE",
+    "POINTER_TYPE",
+    // values
+    "BOOL_VAL", "INT_VAL", "DOUBLE_VAL", "STRING_VAL", "CHAR_VAL", "ID",
+    "NIL", "POINTER_VAL",
+    // eos
+    "EOS"
+  };
+  static_assert(sizeof(names) / sizeof(names[0]) == EOS + 1,
+                "a name for each token type");
+  return names[type];
+}
+
+
 std::string Token::to_string() const
 {
-  return token_type_map.find(token_type)->second +
+  return std::string(type_name(token_type)) +
     " '" + lexeme() + "' " +
     std::to_string(line()) + ":" + std::to_string(column());
 }
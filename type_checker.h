@@ -2,7 +2,9 @@
 // NAME: Weston Averill
 // FILE: type_checker.h
 // DATE: 3/20/2021
-// DESC: Type check mypl programs
+// DESC: Type check mypl programs. Types are integer ids (the
+//       primitive types, then one per type name) and names are looked
+//       up by their interned symbols, so checks compare integers.
 //----------------------------------------------------------------------
 
 
@@ -10,14 +12,19 @@
 #define TYPE_CHECKER_H
 
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "ast.h"
-#include "symbol_table.h"
 
 
 class TypeChecker : public Visitor
 {
 public:
 
+  // registers the primitive types
+  TypeChecker();
+
   // top-level
   void visit(Program& node);
   void visit(FunDecl& node);
@@ -44,22 +51,110 @@ public:
 
 private:
 
-  // the symbol table 
-  SymbolTable sym_table;
+  // the primitive type ids (type names seen later follow these)
+  enum {NIL_T, BOOL_T, INT_T, DOUBLE_T, CHAR_T, STRING_T};
+
+  // a variable (or parameter) in scope
+  struct Var {
+    int type;
+    int slot;
+  };
+
+  // a field of a user-defined type (fields are laid out in
+  // declaration order)
+  struct Field {
+    int type;
+    int offset;
+  };
+
+  // a type's fields, and whether its declaration has been seen
+  struct TypeInfo {
+    Symbol name;
+    bool declared = false;
+    std::unordered_map<Symbol,Field> fields;
+  };
+
+  // the id of each type name, and each type by id
+  std::unordered_map<Symbol,int> type_ids;
+  std::vector<TypeInfo> types;
+
+  // function signatures (parameter types then the return type)
+  std::unordered_map<Symbol,std::vector<int>> functions;
+
+  // user functions a tail call can jump to (the built-ins and
+  // functions with pointer parameters, which can refer into the
+  // caller's frame, need a call of their own)
+  std::unordered_set<Symbol> tail_callable;
+
+  // the variables declared in each environment (innermost last)
+  std::vector<std::unordered_map<Symbol,Var>> envs;
+
+  // the return type of the function being checked
+  int return_type = NIL_T;
 
   // the previously inferred type
-  std::string curr_type;
+  int curr_type = NIL_T;
+
+  // the number of slots used by the function (or type) being checked
+  int frame_size = 0;
+
+  // the for loops being checked (innermost last)
+  std::vector<ForStmt*> loops;
+
+  // the program being checked (its arena holds the field sites)
+  Program* program = nullptr;
+
+  // push/pop an environment
+  void push_environment();
+  void pop_environment();
+
+  // the id of a type name (a new name gets the next id)
+  int type_id(Symbol name);
+
+  // declare a variable in the current environment with the next slot
+  int add_var(Symbol name, int type);
+
+  // find a variable in the current or ancestor environments (nullptr
+  // if there is none)
+  const Var* find_var(Symbol name) const;
+
+  // true if the name is taken by a function or a declared type
+  bool is_global(Symbol name) const;
+
+  // a variable is written (or may be, through its address): a loop
+  // over it is no longer a counting loop
+  void written(int slot);
+
+  // infer the type of a variable and field path, and resolve its slot
+  // and a field site (owning type and offset) for each later id; site
+  // is the number of the first
+  void check_path(const Span<Token>& path, int& slot, int& site);
 
   // helper to add built in functions
   void initialize_built_in_types();
 
+  // store a literal's value on the node (out of range numbers are
+  // left undecoded and reported if evaluated)
+  void decode(SimpleRValue& node);
+
+  // the specialized operation for a binary operator's operand types
+  Kernel select_kernel(BinOp op, int lhs_type, int rhs_type) const;
+
   // error message
   void error(const std::string& msg, const Token& token);
-  void error(const std::string& msg); 
+  void error(const std::string& msg);
 
 };
 
 
+TypeChecker::TypeChecker()
+{
+  // in the order of the primitive type ids
+  for (const char* name : {"nil", "bool", "int", "double", "char", "string"})
+    type_id(Interner::intern(name));
+}
+
+
 void TypeChecker::error(const std::string& msg, const Token& token)
 {
   throw MyPLException(SEMANTIC, msg, token.line(), token.column());
@@ -71,56 +166,183 @@ void TypeChecker::error(const std::string& msg)
   throw MyPLException(SEMANTIC, msg);
 }
 
-void TypeChecker::initialize_built_in_types()
+// chars are left generic: get() gives a char statically but a string
+// at run time
+Kernel TypeChecker::select_kernel(BinOp op, int lhs_type, int rhs_type) const
 {
-  // print function
-  sym_table.add_name("print");
-  sym_table.set_vec_info("print", StringVec {"string", "nil"});
-  // stoi function
-  sym_table.add_name("stoi");
-  sym_table.set_vec_info("stoi", StringVec {"string", "int"});  
+  if (lhs_type != rhs_type)
+    return Kernel::GENERIC;
+  if (lhs_type == INT_T) {
+    switch (op) {
+      case BinOp::ADD: return Kernel::INT_ADD;
+      case BinOp::SUB: return Kernel::INT_SUB;
+      case BinOp::MUL: return Kernel::INT_MUL;
+      case BinOp::DIV: return Kernel::INT_DIV;
+      case BinOp::MOD: return Kernel::INT_MOD;
+      case BinOp::EQ: return Kernel::INT_EQ;
+      case BinOp::NE: return Kernel::INT_NE;
+      case BinOp::LT: return Kernel::INT_LT;
+      case BinOp::LE: return Kernel::INT_LE;
+      case BinOp::GT: return Kernel::INT_GT;
+      case BinOp::GE: return Kernel::INT_GE;
+      default: return Kernel::GENERIC;
+    }
+  }
+  // (double equality compares the printed values, so stays generic)
+  if (lhs_type == DOUBLE_T) {
+    switch (op) {
+      case BinOp::ADD: return Kernel::DOUBLE_ADD;
+      case BinOp::SUB: return Kernel::DOUBLE_SUB;
+      case BinOp::MUL: return Kernel::DOUBLE_MUL;
+      case BinOp::DIV: return Kernel::DOUBLE_DIV;
+      case BinOp::LT: return Kernel::DOUBLE_LT;
+      case BinOp::LE: return Kernel::DOUBLE_LE;
+      case BinOp::GT: return Kernel::DOUBLE_GT;
+      case BinOp::GE: return Kernel::DOUBLE_GE;
+      default: return Kernel::GENERIC;
+    }
+  }
+  if (lhs_type == STRING_T and op == BinOp::ADD)
+    return Kernel::STRING_CONCAT;
+  return Kernel::GENERIC;
+}
 
-  // TODO: finish the rest of the built-in functions: stod, itos,
-  // dtos, get, length, and read
-  sym_table.add_name("stod");
-  sym_table.set_vec_info("stod", StringVec {"string", "double"});
+void TypeChecker::push_environment()
+{
+  envs.push_back({});
+}
+
+void TypeChecker::pop_environment()
+{
+  envs.pop_back();
+}
+
+int TypeChecker::type_id(Symbol name)
+{
+  auto it = type_ids.find(name);
+  if (it != type_ids.end())
+    return it->second;
+  int id = types.size();
+  type_ids[name] = id;
+  types.push_back(TypeInfo());
+  types.back().name = name;
+  return id;
+}
+
+int TypeChecker::add_var(Symbol name, int type)
+{
+  envs.back()[name] = Var {type, frame_size};
+  return frame_size++;
+}
 
-  sym_table.add_name("itos");
-  sym_table.set_vec_info("itos", StringVec {"int", "string"});
+const TypeChecker::Var* TypeChecker::find_var(Symbol name) const
+{
+  for (size_t i = envs.size(); i > 0; --i) {
+    auto it = envs[i-1].find(name);
+    if (it != envs[i-1].end())
+      return &it->second;
+  }
+  return nullptr;
+}
 
-  sym_table.add_name("dtos");
-  sym_table.set_vec_info("dtos", StringVec {"double", "string"});
+void TypeChecker::written(int slot)
+{
+  for (ForStmt* loop : loops)
+    if (loop->slot == slot)
+      loop->counted = false;
+}
 
-  sym_table.add_name("get");
-  sym_table.set_vec_info("get", StringVec {"int","string", "char"});
+bool TypeChecker::is_global(Symbol name) const
+{
+  if (functions.count(name) > 0)
+    return true;
+  auto it = type_ids.find(name);
+  return it != type_ids.end() and types[it->second].declared;
+}
 
-  sym_table.add_name("length");
-  sym_table.set_vec_info("length", StringVec {"string","int"});
+void TypeChecker::check_path(const Span<Token>& path, int& slot, int& site)
+{
+  const Token* it = path.begin();
+  const Var* var = find_var(it->symbol());
+  if (!var)
+    error("use before defition", *it);
+  curr_type = var->type;
+  slot = var->slot;
+  site = program->field_sites.size();
+  ++it;
+  for (; it != path.end(); ++it) {
+    const std::unordered_map<Symbol,Field>& fields = types[curr_type].fields;
+    auto field = fields.find(it->symbol());
+    if (field == fields.end()) {
+      error("no member in type", *it);
+    }
+    program->arena.append(program->field_sites,
+                          FieldSite{types[curr_type].name,
+                                    field->second.offset});
+    curr_type = field->second.type;
+  }
+}
+
+void TypeChecker::decode(SimpleRValue& node)
+{
+  if (node.decoded)
+    return;
+  const std::string& lexeme = node.value.lexeme();
+  try {
+    if (node.value.type() == CHAR_VAL)
+      node.val.set(lexeme.at(0));
+    else if (node.value.type() == STRING_VAL)
+      node.val.set(lexeme);
+    else if (node.value.type() == INT_VAL)
+      node.val.set(std::stoi(lexeme));
+    else if (node.value.type() == DOUBLE_VAL)
+      node.val.set(std::stod(lexeme));
+    else if (node.value.type() == BOOL_VAL)
+      node.val.set(lexeme == "true");
+    else
+      node.val.set_nil();
+    node.decoded = true;
+  }
+  catch (const std::exception& e) {
+  }
+}
+
+void TypeChecker::initialize_built_in_types()
+{
+  // print function
+  functions[Interner::intern("print")] = {STRING_T, NIL_T};
+  // stoi function
+  functions[Interner::intern("stoi")] = {STRING_T, INT_T};
 
-  sym_table.add_name("read");
-  sym_table.set_vec_info("read", StringVec {"string"});
+  // TODO: finish the rest of the built-in functions: stod, itos,
+  // dtos, get, length, and read
+  functions[Interner::intern("stod")] = {STRING_T, DOUBLE_T};
+  functions[Interner::intern("itos")] = {INT_T, STRING_T};
+  functions[Interner::intern("dtos")] = {DOUBLE_T, STRING_T};
+  functions[Interner::intern("get")] = {INT_T, STRING_T, CHAR_T};
+  functions[Interner::intern("length")] = {STRING_T, INT_T};
+  functions[Interner::intern("read")] = {STRING_T};
 }
 
 
 void TypeChecker::visit(Program& node)
 {
+  program = &node;
   // push the global environment
-  sym_table.push_environment();
+  push_environment();
   // add built-in functions
   initialize_built_in_types();
-  // push 
+  // push
   for (Decl* d : node.decls) {
     d->accept(*this);
   }
   // check for a main function
-  if (sym_table.name_exists("main") && sym_table.has_vec_info("main")) {
+  auto main = functions.find(Interner::intern("main"));
+  if (main != functions.end()) {
     // TODO: finish checking that the main function is defined with
     // the correct signature
-    StringVec sv;
-    sym_table.get_vec_info("main", sv);
-    std::string return_type = sv[sv.size()-1]; 
     //may need to do someting is with return type
-    if (return_type != "int")
+    if (main->second.back() != INT_T)
       error("incorrect return type for main");
   }
   else {
@@ -129,242 +351,237 @@ void TypeChecker::visit(Program& node)
     error("undefined 'main' function");
   }
    // pop the global environment
-  sym_table.pop_environment();
+  pop_environment();
 }
 
-void TypeChecker::visit(FunDecl& node) 
+void TypeChecker::visit(FunDecl& node)
 {
-  if (sym_table.name_exists_in_curr_env(node.id.lexeme())) {
+  if (is_global(node.id.symbol())) {
     error("function delcared already", node.id);
   }
   //push the paramaters of function to the vector
-  StringVec the_type;
-  for (FunDecl::FunParam f : node.params) {
-    the_type.push_back(f.type.lexeme());
+  std::vector<int> the_type;
+  for (const FunDecl::FunParam& f : node.params) {
+    the_type.push_back(type_id(f.type.symbol()));
   }
   //now we need to push the return type
-  the_type.push_back(node.return_type.lexeme());
-  //now we neeed to add function signature to symbol table
-  sym_table.add_name(node.id.lexeme());
-  sym_table.set_vec_info(node.id.lexeme(), the_type);
-
-  //add a new environment and a special return name
-  sym_table.push_environment();
-  sym_table.add_name("return");
-  sym_table.set_str_info("return", node.return_type.lexeme());
+  the_type.push_back(type_id(node.return_type.symbol()));
+  //now we neeed to add function signature to the function table
+  functions[node.id.symbol()] = the_type;
+  bool by_reference = false;
+  for (const FunDecl::FunParam& f : node.params)
+    by_reference = by_reference || f.id.type() == POINTER_TYPE;
+  if (!by_reference)
+    tail_callable.insert(node.id.symbol());
+
+  //add a new environment and note the return type
+  frame_size = 0;
+  push_environment();
+  return_type = the_type.back();
 
   //add parameters to environment
-  //use map to keep track of the names
-  StringMap map;
-  for (FunDecl::FunParam v : node.params) {
+  for (size_t i = 0; i < node.params.size(); ++i) {
+    const FunDecl::FunParam& v = node.params[i];
     //check for duplicate parameter names (semantic error)
-    if (map.count(v.id.lexeme()) > 0){
+    if (envs.back().count(v.id.symbol()) > 0){
       error("duplicate parameter name", v.id);
     }
      //add param name and types to environemnt
-    map[v.id.lexeme()] = v.type.lexeme();
-    sym_table.add_name(v.id.lexeme());
-    sym_table.set_str_info(v.id.lexeme(), v.type.lexeme());
+    add_var(v.id.symbol(), the_type[i]);
   }
 
   //finally, check the body
   for (Stmt* s : node.stmts)
     s->accept(*this);
-  
+  node.frame_size = frame_size;
+
   //cleanup
-  sym_table.pop_environment();
+  pop_environment();
 }
 
-void TypeChecker::visit(TypeDecl& node) 
+void TypeChecker::visit(TypeDecl& node)
 {
-  StringMap map;
-  sym_table.add_name(node.id.lexeme());
-  sym_table.push_environment();
+  int id = type_id(node.id.symbol());
+  types[id].declared = true;
+  frame_size = 0;
+  push_environment();
+  int offset = 0;
   for (VarDeclStmt* v : node.vdecls) {
     v->accept(*this);
-    std::string temp = curr_type;
+    int field_type = curr_type;
     if (v->type != nullptr) {
-      map[v->id.lexeme()] = v->type->lexeme();
-    }
-    else {
-      map[v->id.lexeme()] = temp;
+      field_type = type_id(v->type->symbol());
     }
+    types[id].fields[v->id.symbol()] = Field {field_type, offset++};
   }
-  sym_table.pop_environment();
-  sym_table.set_map_info(node.id.lexeme(), map);
+  node.frame_size = frame_size;
+  pop_environment();
 }
 
 // statements
-void TypeChecker::visit(VarDeclStmt& node) 
+void TypeChecker::visit(VarDeclStmt& node)
 {
   node.expr->accept(*this);
-  std::string exp_type = curr_type;
-  std::string var_name = node.id.lexeme();
+  int exp_type = curr_type;
+  Symbol var_name = node.id.symbol();
 
   //check for shadowing
-  if (sym_table.name_exists_in_curr_env(var_name)) {
+  if (envs.back().count(var_name) > 0) {
     error("redefinition of variable", node.id);
   }
   //check the variable type
-  if (node.type != nullptr && node.type->lexeme() != exp_type && exp_type != "nil") {
-    error("mismatch type in variable declaration", node.id);
-  }
-  //etc..
-  //add to symbol tables
+  int var_type = exp_type;
   if (node.type != nullptr) {
-    sym_table.add_name(var_name);
-    sym_table.set_str_info(var_name, node.type->lexeme());
-  }
-  else {
-    sym_table.add_name(var_name);
-    sym_table.set_str_info(var_name, curr_type);
+    var_type = type_id(node.type->symbol());
+    if (var_type != exp_type && exp_type != NIL_T) {
+      error("mismatch type in variable declaration", node.id);
+    }
   }
-  
+  //etc..
+  //add to the environment
+  node.slot = add_var(var_name, var_type);
+  //a ~ variable set to a value (not &x or ~q) points at a hidden cell
+  SimpleTerm* term = dynamic_cast<SimpleTerm*>(node.expr->first);
+  bool reference = !node.expr->negated && !node.expr->op && term &&
+    (dynamic_cast<PointerValue*>(term->rvalue) ||
+     dynamic_cast<PointerType*>(term->rvalue));
+  if (node.pointer && !reference)
+    node.cell = frame_size++;
 }
 
-void TypeChecker::visit(AssignStmt& node) 
+void TypeChecker::visit(AssignStmt& node)
 {
   //infer rhs type
   node.expr->accept(*this);
-  std::string rhs_type = curr_type;
-  //cout << rhs_type << "   ";
+  int rhs_type = curr_type;
   //infer lhs type
-  std::string lhs_type;
-  std::list<Token>::iterator it = node.lvalue_list.begin();
-  if (!sym_table.name_exists(it->lexeme()))
-    error("use before defition", *it);
-  sym_table.get_str_info(it->lexeme(), curr_type);
-  ++it;
-  for (; it != node.lvalue_list.end(); ++it) {
-    StringMap info;
-    sym_table.get_map_info(curr_type, info);
-    StringMap::iterator prop = info.find(it->lexeme());
-    if (prop == info.end()) {
-      error("no member in type", *it);
-    }
-    curr_type = info[it->lexeme()];
-  }
-  lhs_type = curr_type;
+  check_path(node.lvalue_list, node.slot, node.site);
+  int lhs_type = curr_type;
+  if (node.lvalue_list.size() == 1)
+    written(node.slot);
 
   //check types: error if the rhs and lhs types don't match
-  if (rhs_type != "nil" && lhs_type != rhs_type) {
-    //cout << lhs_type << " " << rhs_type;
+  if (rhs_type != NIL_T && lhs_type != rhs_type) {
     std::string msg = "mismatched types in assignment";
     error(msg, node.lvalue_list.front());
   }
 
 }
 
-void TypeChecker::visit(ReturnStmt& node) 
+void TypeChecker::visit(ReturnStmt& node)
 {
   node.expr->accept(*this);
-  std::string rt = curr_type;
-  std::string funReturn;
-  //this gets the functions return type
-  sym_table.get_str_info("return", funReturn);
-  //if the function doesn't return the correct type, 
+  int rt = curr_type;
+  //if the function doesn't return the correct type,
   //we need to trhow an error
-  if (funReturn != rt && rt != "nil") {
+  if (return_type != rt && rt != NIL_T) {
     error("mismatch in return types", node.expr->first_token());
   }
+  //returning a call's value as is makes it a tail call
+  SimpleTerm* term = dynamic_cast<SimpleTerm*>(node.expr->first);
+  CallExpr* call = term ? dynamic_cast<CallExpr*>(term->rvalue) : nullptr;
+  if (!node.expr->negated && !node.expr->op && call &&
+      tail_callable.count(call->function_id.symbol()) > 0)
+    call->tail = true;
 }
 
-void TypeChecker::visit(IfStmt& node) 
+void TypeChecker::visit(IfStmt& node)
 {
-  sym_table.push_environment();
-  node.if_part->expr->accept(*this);          
-  std::string ifStmtType = curr_type;
+  push_environment();
+  node.if_part->expr->accept(*this);
   //check the if statement expression
-  if (ifStmtType != "bool") {
+  if (curr_type != BOOL_T) {
     //maybe we can throw error that shows line and column
     error("Non-boolean expression in if statement", node.if_part->expr->first_token());
   }
   //now lets call accept on the if statements statments
-  sym_table.push_environment();
+  push_environment();
   for (Stmt* s : node.if_part->stmts) {
     s->accept(*this);
   }
-  sym_table.pop_environment();
+  pop_environment();
   for (BasicIf* i : node.else_ifs) {
     i->expr->accept(*this);
-    ifStmtType = curr_type;
-    if (ifStmtType != "bool") {
+    if (curr_type != BOOL_T) {
       //try to throw better error with line and column
       error("Non-boolean expression in if statement", i->expr->first_token());
     }
-    sym_table.push_environment();
+    push_environment();
     for (Stmt* s : i->stmts) {
       s->accept(*this);
     }
-    sym_table.pop_environment();
+    pop_environment();
   }
-  sym_table.push_environment();
+  push_environment();
   for (Stmt* s : node.body_stmts) {
     s->accept(*this);
   }
-  sym_table.pop_environment();
-  sym_table.pop_environment();
+  pop_environment();
+  pop_environment();
 }
 
-void TypeChecker::visit(WhileStmt& node) 
+void TypeChecker::visit(WhileStmt& node)
 {
-  sym_table.push_environment();
+  push_environment();
   node.expr->accept(*this);
-  std::string whileStmtType = curr_type;
   //check to see if its a bool expression
-  if (whileStmtType != "bool") {
+  if (curr_type != BOOL_T) {
     //throw error if not
     error("Non-boolean expression in while statement", node.expr->first_token());
   }
 
   //now check each stmt in while loop
-  sym_table.push_environment();
+  push_environment();
   for (Stmt* s : node.stmts) {
     s->accept(*this);
   }
-  sym_table.pop_environment();
-  sym_table.pop_environment();
+  pop_environment();
+  pop_environment();
 }
 
-void TypeChecker::visit(ForStmt& node) 
+void TypeChecker::visit(ForStmt& node)
 {
-  sym_table.push_environment();
+  push_environment();
 
-  sym_table.add_name(node.var_id.lexeme());
+  //the bounds are checked before the loop variable is declared, so
+  //neither can refer to it
   if (node.start != nullptr) {
     node.start->accept(*this);
   }
-  std::string strt = curr_type;
-  sym_table.set_str_info(node.var_id.lexeme(), strt);
+  int strt = curr_type;
   if (node.end != nullptr) {
     node.end->accept(*this);
   }
-  std::string nd = curr_type;
+  int nd = curr_type;
 
   if (strt != nd) {
     error("mismatch types in for statement", node.var_id);
   }
-  sym_table.push_environment();
+  node.slot = add_var(node.var_id.symbol(), strt);
+  node.counted = strt == INT_T;
+  loops.push_back(&node);
+  push_environment();
   //now check the body of the for stmt
   for (Stmt* s : node.stmts) {
     s->accept(*this);
   }
-  sym_table.pop_environment();
-  sym_table.pop_environment();
+  pop_environment();
+  loops.pop_back();
+  pop_environment();
 }
 
   // expressions
-void TypeChecker::visit(Expr& node) 
+void TypeChecker::visit(Expr& node)
 {
   //check the first exists
   if (node.first != nullptr)
     node.first->accept(*this);
-  std::string firstType = curr_type;
-  std::string restType;
+  int firstType = curr_type;
+  int restType;
   //check if not an operator
   if(node.op == nullptr) {
     //rule 23 i think
-    if (node.negated && firstType != "bool") {
+    if (node.negated && firstType != BOOL_T) {
       error("expecting a boolean expression", node.first_token());
     }
   }
@@ -376,124 +593,128 @@ void TypeChecker::visit(Expr& node)
     }
     node.rest->accept(*this);
     restType = curr_type;
+    BinOp op = node.bin_op;
+    bool equality = op == BinOp::EQ || op == BinOp::NE;
+    bool relational = op == BinOp::LT || op == BinOp::GT ||
+      op == BinOp::LE || op == BinOp::GE;
     //rule 2
-    if (node.op->lexeme() == "+" || node.op->lexeme() == "-" ||
-    node.op->lexeme() == "*" || node.op->lexeme() == "/") {
-      if ((firstType == "int" && restType == "double")
-      || (firstType == "double" && restType == "int")) {
+    if (op == BinOp::ADD || op == BinOp::SUB ||
+    op == BinOp::MUL || op == BinOp::DIV) {
+      if ((firstType == INT_T && restType == DOUBLE_T)
+      || (firstType == DOUBLE_T && restType == INT_T)) {
         error("can't do operations on ints and doubles", *node.op);
       }
-      else if (firstType == restType && firstType == "int") {
-        curr_type = "int";
+      else if (firstType == restType && firstType == INT_T) {
+        curr_type = INT_T;
       }
-      else if (firstType == restType && firstType == "double") {
-        curr_type = "double";
+      else if (firstType == restType && firstType == DOUBLE_T) {
+        curr_type = DOUBLE_T;
       }
-      else if (firstType == "int" && (restType == "char" || restType == "string" || restType == "bool")) {
+      else if (firstType == INT_T && (restType == CHAR_T || restType == STRING_T || restType == BOOL_T)) {
         error("mismatch in types in " + node.op->lexeme(), node.first_token());
       }
-      else if (firstType == "double" && (restType == "char" || restType == "string" || restType == "bool")) {
+      else if (firstType == DOUBLE_T && (restType == CHAR_T || restType == STRING_T || restType == BOOL_T)) {
         error("mismatch in types in " + node.op->lexeme(), node.first_token());
       }
-      else if (firstType == "char" && (restType == "double" || restType == "bool" || restType == "int")) {
+      else if (firstType == CHAR_T && (restType == DOUBLE_T || restType == BOOL_T || restType == INT_T)) {
         error("mismatch in types in " + node.op->lexeme(), node.first_token());
       }
-      else if (firstType == "string" && (restType == "double" || restType == "bool" || restType == "int")) {
+      else if (firstType == STRING_T && (restType == DOUBLE_T || restType == BOOL_T || restType == INT_T)) {
         error("mismatch in types in " + node.op->lexeme(), node.first_token());
       }
     }
     //rule 4
-    if (node.op->lexeme() == "%" && (firstType != "int" || restType != "int")) {
+    if (op == BinOp::MOD && (firstType != INT_T || restType != INT_T)) {
       error("use of modulo without int", *node.op);
     }
     //rule5
-    else if (node.op->lexeme() == "+" && ((firstType == "string" && restType == "char") 
-    || (firstType == "char" && restType == "string"))) {
-      curr_type = "string";
+    else if (op == BinOp::ADD && ((firstType == STRING_T && restType == CHAR_T)
+    || (firstType == CHAR_T && restType == STRING_T))) {
+      curr_type = STRING_T;
     }
-    else if (node.op->lexeme() == "+" && firstType == restType && 
-    (firstType == "char" || firstType == "string")) {
-      curr_type = "string";
+    else if (op == BinOp::ADD && firstType == restType &&
+    (firstType == CHAR_T || firstType == STRING_T)) {
+      curr_type = STRING_T;
     }
     //rule 18 & 19
-    else if ((firstType == "nil" && restType != "nil") || (firstType != "nil" && restType == "nil") 
-    && (node.op->lexeme() == "==" || node.op->lexeme() == "!=")) {
-      curr_type = "bool";
+    else if ((firstType == NIL_T && restType != NIL_T) || (firstType != NIL_T && restType == NIL_T)
+    && equality) {
+      curr_type = BOOL_T;
     }
     //rule 17
-    else if (firstType == restType && (node.op->lexeme() == "!=" || node.op->lexeme() == "==")) {
-      curr_type = "bool";
+    else if (firstType == restType && equality) {
+      curr_type = BOOL_T;
     }
-    else if (firstType != restType && (node.op->lexeme() == "!=" || node.op->lexeme() == "==")) {
+    else if (firstType != restType && equality) {
       error("mismatch types", node.first_token());
     }
     //rule 20
-    else if (firstType == restType && firstType != "bool" && firstType != "nil"
-    && (node.op->lexeme() == "<" || node.op->lexeme() == ">"
-    || node.op->lexeme() == "<=" || node.op->lexeme() == ">=")){
-      curr_type = "bool";
+    else if (firstType == restType && firstType != BOOL_T && firstType != NIL_T
+    && relational){
+      curr_type = BOOL_T;
     }
-    else if (firstType != restType && firstType != "nil" && restType != "nil" &&
-    firstType != "bool" && restType != "bool" && (node.op->lexeme() == "<" || 
-    node.op->lexeme() == ">" || node.op->lexeme() == "<=" || node.op->lexeme() == ">=")){
+    else if (firstType != restType && firstType != NIL_T && restType != NIL_T &&
+    firstType != BOOL_T && restType != BOOL_T && relational){
       error("mismatched types", node.first_token());
     }
     //rule 24
-    else if ((node.op->lexeme() == "and" || node.op->lexeme() == "or") && 
-    (firstType != "bool" || restType != "bool")) {
+    else if ((op == BinOp::AND || op == BinOp::OR) &&
+    (firstType != BOOL_T || restType != BOOL_T)) {
       error("expecting a boolean", node.first_token());
     }
+    //the operand types pick the operation to run
+    node.kernel = select_kernel(op, firstType, restType);
   }
 }
 
-void TypeChecker::visit(SimpleTerm& node) 
+void TypeChecker::visit(SimpleTerm& node)
 {
-  if (node.rvalue != nullptr) 
+  if (node.rvalue != nullptr)
     node.rvalue->accept(*this);
 }
 
-void TypeChecker::visit(ComplexTerm& node) 
+void TypeChecker::visit(ComplexTerm& node)
 {
   if (node.expr != nullptr)
     node.expr->accept(*this);
 }
   // rvalues
-void TypeChecker::visit(SimpleRValue& node) 
+void TypeChecker::visit(SimpleRValue& node)
 {
   // infer type based on token type
   if (node.value.type() == CHAR_VAL)
-    curr_type = "char" ;
+    curr_type = CHAR_T;
   else if (node.value.type() == STRING_VAL)
-    curr_type = "string" ;
+    curr_type = STRING_T;
   else if (node.value.type() == INT_VAL)
-    curr_type = "int" ;
+    curr_type = INT_T;
   else if (node.value.type() == DOUBLE_VAL)
-    curr_type = "double" ;
+    curr_type = DOUBLE_T;
   else if (node.value.type() == BOOL_VAL)
-    curr_type = "bool" ;
+    curr_type = BOOL_T;
   else if (node.value.type() == NIL)
-    curr_type = "nil" ;
-
+    curr_type = NIL_T;
+  decode(node);
 }
-void TypeChecker::visit(NewRValue& node) 
+void TypeChecker::visit(NewRValue& node)
 {
-  if (!sym_table.name_exists(node.type_id.lexeme())) {
+  auto it = type_ids.find(node.type_id.symbol());
+  if (it == type_ids.end() || !types[it->second].declared) {
     error("no matching types", node.type_id);
   }
-  curr_type = node.type_id.lexeme();
+  curr_type = it->second;
 }
 
-void TypeChecker::visit(CallExpr& node) 
+void TypeChecker::visit(CallExpr& node)
 {
   //check to make sure the function exists,
   //if its doesn't throw error
-  if (!sym_table.has_vec_info(node.function_id.lexeme())) {
+  auto fun = functions.find(node.function_id.symbol());
+  if (fun == functions.end()) {
     error("no function defined", node.function_id);
   }
   //now we have to get the function signature
-  std::string fun_name = node.function_id.lexeme();
-  StringVec fun_type;
-  sym_table.get_vec_info(fun_name, fun_type);
+  const std::vector<int>& fun_type = fun->second;
 
   //check thre are enough args
   if (fun_type.size()-1 > node.arg_list.size()) {
@@ -503,69 +724,55 @@ void TypeChecker::visit(CallExpr& node)
     error("too many args given", node.function_id);
   }
 
-  std::string temp;
   int i = 0;
   //go through each argument
   for (Expr* e : node.arg_list) {
     e->accept(*this);
-    temp = curr_type;
-    //cout << node.function_id.lexeme();
-    //cout << temp;
     //now check to make sure the types align
-    if (temp != "nil" && temp != fun_type[i]) { 
-      //cout << fun_type[i];
+    if (curr_type != NIL_T && curr_type != fun_type[i]) {
       error("parameter types do not match for function call", node.function_id);
     }
     i++;
   }
-  curr_type = fun_type[fun_type.size()-1];
+  curr_type = fun_type.back();
 }
 
-void TypeChecker::visit(IDRValue& node) 
+void TypeChecker::visit(IDRValue& node)
 {
-  std::list<Token>::iterator it = node.path.begin();
-  if (!sym_table.name_exists(it->lexeme()))
-    error("use before defition", *it);
-  sym_table.get_str_info(it->lexeme(), curr_type);
-  ++it;
-  for (; it != node.path.end(); ++it) {
-    StringMap info;
-    sym_table.get_map_info(curr_type, info);
-    StringMap::iterator temp = info.find(it->lexeme());
-    if (temp == info.end()) {
-      error("no member in type", *it);
-    }
-    curr_type = info[it->lexeme()];
-  }
+  check_path(node.path, node.slot, node.site);
 }
 
-void TypeChecker::visit(NegatedRValue& node) 
+void TypeChecker::visit(NegatedRValue& node)
 {
   if (node.expr != nullptr)
     node.expr->accept(*this);
   //rule3
-  if (curr_type != "int" && curr_type != "double")
+  if (curr_type != INT_T && curr_type != DOUBLE_T)
     error("can't negate", node.expr->first_token());
-  
+
 }
 
-void TypeChecker::visit(PointerType& node) 
+void TypeChecker::visit(PointerType& node)
 {
-  std::string str = node.pointer.lexeme();
-  if (!sym_table.name_exists(str)) {
+  const Var* var = find_var(node.pointer.symbol());
+  if (!var) {
     error("this has not been declared yet ", node.first_token());
   }
-  sym_table.get_str_info(str, curr_type);
+  curr_type = var->type;
+  node.slot = var->slot;
 }
 
 void TypeChecker::visit(PointerValue& node)
 {
-  std::string str = node.pointer.lexeme();
-  str = str.substr(1);
-  if (!sym_table.name_exists_in_curr_env(str)) {
+  //the variable named after the '&'
+  Symbol name = Interner::intern(node.pointer.lexeme().substr(1));
+  auto var = envs.back().find(name);
+  if (var == envs.back().end()) {
     error("this variable has not been declared yet ", node.first_token());
   }
-  sym_table.get_str_info(str, curr_type);
+  curr_type = var->second.type;
+  node.slot = var->second.slot;
+  written(node.slot);
 }
 
 #endif
@@ -0,0 +1,792 @@
+//----------------------------------------------------------------------
+// NAME: Weston Averill
+// FILE: vm.h
+// DATE: 10/17/2026
+// DESC: Stack-based virtual machine that runs compiled MyPL bytecode.
+//       Each call gets a frame whose locals live on the value stack
+//       starting at the frame's base index.
+//----------------------------------------------------------------------
+
+
+#ifndef VM_H
+#define VM_H
+
+#include <algorithm>
+#include <iostream>
+#include "bytecode.h"
+#include "data_object.h"
+#include "heap.h"
+#include "mypl_exception.h"
+#include "profiler.h"
+
+
+// Instruction dispatch. With GCC and Clang each handler jumps straight
+// to the next instruction's handler through a table of label addresses
+// (labels-as-values), giving every handler its own indirect branch for
+// the predictor to learn. Defining MYPL_SWITCH_DISPATCH (the CMake
+// option of the same name) selects the portable switch loop instead.
+#if defined(__GNUC__) and !defined(MYPL_SWITCH_DISPATCH)
+#define MYPL_THREADED_DISPATCH
+#endif
+
+// (A computed goto doesn't run destructors, so a handler must not have
+// a local with one in scope when it dispatches.)
+#ifdef MYPL_THREADED_DISPATCH
+#define TARGET(op) L_##op:
+#define DISPATCH()                                    \
+  do {                                                \
+    instr = &frame->code->instrs[frame->ip++];        \
+    goto *labels[instr->op];                          \
+  } while (0)
+#else
+#define TARGET(op) case op:
+#define DISPATCH() continue
+#endif
+
+// the dispatch this build uses (for reports)
+#ifdef MYPL_THREADED_DISPATCH
+const char* const VM_DISPATCH = "threaded";
+#else
+const char* const VM_DISPATCH = "switch";
+#endif
+
+
+class VM
+{
+public:
+
+  // create a VM for the given compiled program
+  VM(const Bytecode& program);
+
+  // run the program's main function
+  void run();
+
+  // return code from calling main
+  int return_code() const;
+
+  // the object heap (for collector settings and statistics)
+  Heap& get_heap();
+
+  // record user function calls and allocations (nullptr to disable)
+  void set_profiler(Profiler* prof);
+
+  // flush output after each print of a newline (instead of at exit)
+  void set_line_flush(bool flush);
+
+  // the most calls that can be active at once (more is a runtime
+  // error)
+  void set_max_stack_depth(size_t depth);
+
+  // field inline cache hits and misses so far
+  const FieldCacheStats& get_field_stats() const;
+
+private:
+
+  // an active function call
+  struct Frame {
+    const CodeObject* code;   // the function being executed
+    size_t ip;                // index of the next instruction
+    size_t base;              // stack index of slot 0
+  };
+
+  // the compiled program
+  const Bytecode& program;
+
+  // operand stack (holds the locals of every active frame)
+  std::vector<DataObject> stack;
+
+  // call stack
+  std::vector<Frame> frames;
+
+  // the heap
+  Heap heap;
+
+  // the next oid
+  size_t next_oid = 0;
+
+  // the profiler (if profiling)
+  Profiler* profiler = nullptr;
+
+  // the program return code
+  int ret_code = 0;
+
+  // output flush policy
+  bool line_flush = false;
+
+  // the limit on active calls (tail calls don't add one)
+  size_t max_depth = 100000;
+
+  // an inline cache per field site (the program itself is const)
+  std::vector<FieldCache> field_caches;
+  FieldCacheStats field_stats;
+
+  // helpers
+  void error(const std::string& msg, const Frame& frame) const;
+  DataObject pop();
+  void collect_garbage();
+  int field_offset(int site, const HeapObject& obj);
+  void binary_op(OpCode op, DataObject& lhs, const DataObject& rhs,
+                 const Frame& frame);
+  // built-ins that need strings of their own (kept out of run() so no
+  // handler there has locals to destroy when it dispatches)
+  void print(const DataObject& val);
+  void get(const Frame& frame);
+  void read(DataObject& val);
+};
+
+
+VM::VM(const Bytecode& program)
+  : program(program)
+{
+  // seed each field site's cache with its type's shape
+  for (const FieldRef& field : program.field_sites)
+    field_caches.push_back(FieldCache(&program.shapes[field.type],
+                                      field.offset));
+}
+
+
+int VM::return_code() const
+{
+  return ret_code;
+}
+
+
+const FieldCacheStats& VM::get_field_stats() const
+{
+  return field_stats;
+}
+
+
+Heap& VM::get_heap()
+{
+  return heap;
+}
+
+
+void VM::set_profiler(Profiler* prof)
+{
+  profiler = prof;
+}
+
+
+void VM::set_line_flush(bool flush)
+{
+  line_flush = flush;
+}
+
+
+void VM::set_max_stack_depth(size_t depth)
+{
+  max_depth = depth;
+}
+
+
+// the value stack holds every frame's locals and temporaries, so it is
+// the only root (references into it are not oids, so mark skips them)
+void VM::collect_garbage()
+{
+  for (const DataObject& val : stack)
+    heap.mark(val);
+  heap.sweep();
+}
+
+
+// the offset of a site's field in obj, through the site's cache
+int VM::field_offset(int site, const HeapObject& obj)
+{
+  return field_caches[site].offset(obj.get_shape(), field_stats);
+}
+
+
+// report an error at the location of the current instruction
+void VM::error(const std::string& msg, const Frame& frame) const
+{
+  size_t at = frame.ip - 1;
+  throw MyPLException(RUNTIME, msg, frame.code->lines[at],
+                      frame.code->columns[at]);
+}
+
+
+DataObject VM::pop()
+{
+  DataObject val = std::move(stack.back());
+  stack.pop_back();
+  return val;
+}
+
+
+void VM::run()
+{
+  const CodeObject* main_code = &program.functions[program.main_id];
+  stack.resize(main_code->num_locals);
+  frames.push_back(Frame{main_code, 0, 0});
+  Frame* frame = &frames.back();
+  if (profiler)
+    profiler->enter(main_code->name);
+  const Instr* instr = nullptr;
+#ifdef MYPL_THREADED_DISPATCH
+  // handler of each opcode, in OpCode order
+  static const void* const labels[] = {
+    &&L_OP_CONST, &&L_OP_NIL, &&L_OP_POP,
+    &&L_OP_LOAD, &&L_OP_STORE, &&L_OP_ADDR,
+    &&L_OP_LOAD_REF, &&L_OP_STORE_REF, &&L_OP_ALLOC,
+    &&L_OP_GET_FIELD, &&L_OP_SET_FIELD, &&L_OP_ADD,
+    &&L_OP_SUB, &&L_OP_MUL, &&L_OP_DIV,
+    &&L_OP_MOD, &&L_OP_AND, &&L_OP_OR,
+    &&L_OP_NOT, &&L_OP_NEG, &&L_OP_EQ,
+    &&L_OP_NE, &&L_OP_LT, &&L_OP_LE,
+    &&L_OP_GT, &&L_OP_GE, &&L_OP_ADD_INT,
+    &&L_OP_SUB_INT, &&L_OP_MUL_INT, &&L_OP_DIV_INT,
+    &&L_OP_MOD_INT, &&L_OP_EQ_INT, &&L_OP_NE_INT,
+    &&L_OP_LT_INT, &&L_OP_LE_INT, &&L_OP_GT_INT,
+    &&L_OP_GE_INT, &&L_OP_ADD_DOUBLE, &&L_OP_SUB_DOUBLE,
+    &&L_OP_MUL_DOUBLE, &&L_OP_DIV_DOUBLE, &&L_OP_LT_DOUBLE,
+    &&L_OP_LE_DOUBLE, &&L_OP_GT_DOUBLE, &&L_OP_GE_DOUBLE,
+    &&L_OP_CONCAT, &&L_OP_JUMP, &&L_OP_JUMP_IF_FALSE,
+    &&L_OP_CALL, &&L_OP_RET, &&L_OP_TAIL_CALL, &&L_OP_JUMP_IF_FALSE_KEEP,
+    &&L_OP_JUMP_IF_TRUE_KEEP, &&L_OP_FOR_ENTER, &&L_OP_FOR_NEXT,
+    &&L_OP_INC_LOCAL, &&L_OP_DEC_LOCAL, &&L_OP_LOAD_ADD_CONST,
+    &&L_OP_LOAD_SUB_CONST, &&L_OP_LOAD_FIELD, &&L_OP_STORE_FIELD,
+    &&L_OP_CMP_JUMP_INT,
+    &&L_OP_PRINT, &&L_OP_STOI, &&L_OP_STOD,
+    &&L_OP_ITOS, &&L_OP_DTOS, &&L_OP_GET,
+    &&L_OP_LENGTH, &&L_OP_READ
+  };
+  static_assert(sizeof(labels) / sizeof(labels[0]) == OP_READ + 1,
+                "a dispatch label is missing");
+  DISPATCH();
+  {                        // (the handlers sit in the blocks the
+    {                      // switch loop uses otherwise)
+#else
+  while (true) {
+    instr = &frame->code->instrs[frame->ip++];
+    switch (instr->op) {
+#endif
+
+      TARGET(OP_CONST)
+        stack.push_back(frame->code->consts[instr->arg]);
+        DISPATCH();
+
+      TARGET(OP_NIL)
+        stack.push_back(DataObject());
+        DISPATCH();
+
+      TARGET(OP_POP)
+        stack.pop_back();
+        DISPATCH();
+
+      TARGET(OP_LOAD)
+        stack.push_back(stack[frame->base + instr->arg]);
+        DISPATCH();
+
+      TARGET(OP_STORE)
+        stack[frame->base + instr->arg] = pop();
+        DISPATCH();
+
+      // a reference is the absolute stack index of a slot
+      TARGET(OP_ADDR)
+        stack.push_back(DataObject());
+        stack.back().set_ref(frame->base + instr->arg);
+        DISPATCH();
+
+      TARGET(OP_LOAD_REF) {
+        size_t addr = 0;
+        stack[frame->base + instr->arg].ref(addr);
+        stack.push_back(stack[addr]);
+        DISPATCH();
+      }
+
+      TARGET(OP_STORE_REF) {
+        size_t addr = 0;
+        stack[frame->base + instr->arg].ref(addr);
+        stack[addr] = pop();
+        DISPATCH();
+      }
+
+      TARGET(OP_ALLOC)
+        if (heap.needs_collection())
+          collect_garbage();
+        if (profiler)
+          profiler->count_alloc();
+        heap.set_obj(next_oid, HeapObject(&program.shapes[instr->arg]));
+        stack.push_back(DataObject(next_oid++));
+        DISPATCH();
+
+      TARGET(OP_GET_FIELD) {
+        size_t oid = 0;
+        HeapObject* obj = nullptr;
+        if (!stack.back().value(oid) or !(obj = heap.get_obj(oid)))
+          error("no attribute name ", *frame);
+        stack.back() = obj->get_field(field_offset(instr->arg, *obj));
+        DISPATCH();
+      }
+
+      TARGET(OP_SET_FIELD) {
+        size_t oid = 0;
+        HeapObject* obj = nullptr;
+        if (!stack.back().value(oid) or !(obj = heap.get_obj(oid)))
+          error("no attribute name", *frame);
+        stack.pop_back();
+        heap.set_field(*obj, field_offset(instr->arg, *obj), pop());
+        DISPATCH();
+      }
+
+      TARGET(OP_ADD) TARGET(OP_SUB) TARGET(OP_MUL) TARGET(OP_DIV) TARGET(OP_MOD)
+      TARGET(OP_AND) TARGET(OP_OR) TARGET(OP_EQ) TARGET(OP_NE) TARGET(OP_LT)
+      TARGET(OP_LE) TARGET(OP_GT) TARGET(OP_GE) {
+        binary_op(instr->op, stack[stack.size() - 2], stack.back(), *frame);
+        stack.pop_back();
+        DISPATCH();
+      }
+
+      // the specialized operators fall back to the generic ones when
+      // an operand is nil
+      TARGET(OP_ADD_INT) TARGET(OP_SUB_INT) TARGET(OP_MUL_INT) TARGET(OP_DIV_INT)
+      TARGET(OP_MOD_INT) TARGET(OP_EQ_INT) TARGET(OP_NE_INT) TARGET(OP_LT_INT)
+      TARGET(OP_LE_INT) TARGET(OP_GT_INT) TARGET(OP_GE_INT) {
+        DataObject& lhs = stack[stack.size() - 2];
+        int l_val, r_val;
+        if (!lhs.value(l_val) or !stack.back().value(r_val)) {
+          binary_op(generic_op(instr->op), lhs, stack.back(), *frame);
+          stack.pop_back();
+          DISPATCH();
+        }
+        stack.pop_back();
+        switch (instr->op) {
+          case OP_ADD_INT: lhs.set(l_val + r_val); break;
+          case OP_SUB_INT: lhs.set(l_val - r_val); break;
+          case OP_MUL_INT: lhs.set(l_val * r_val); break;
+          case OP_DIV_INT: lhs.set(l_val / r_val); break;
+          case OP_MOD_INT: lhs.set(l_val % r_val); break;
+          case OP_EQ_INT: lhs.set(l_val == r_val); break;
+          case OP_NE_INT: lhs.set(l_val != r_val); break;
+          case OP_LT_INT: lhs.set(l_val < r_val); break;
+          case OP_LE_INT: lhs.set(l_val <= r_val); break;
+          case OP_GT_INT: lhs.set(l_val > r_val); break;
+          default: lhs.set(l_val >= r_val); break;
+        }
+        DISPATCH();
+      }
+
+      TARGET(OP_ADD_DOUBLE) TARGET(OP_SUB_DOUBLE) TARGET(OP_MUL_DOUBLE)
+      TARGET(OP_DIV_DOUBLE) TARGET(OP_LT_DOUBLE) TARGET(OP_LE_DOUBLE)
+      TARGET(OP_GT_DOUBLE) TARGET(OP_GE_DOUBLE) {
+        DataObject& lhs = stack[stack.size() - 2];
+        double l_val, r_val;
+        if (!lhs.value(l_val) or !stack.back().value(r_val)) {
+          binary_op(generic_op(instr->op), lhs, stack.back(), *frame);
+          stack.pop_back();
+          DISPATCH();
+        }
+        stack.pop_back();
+        switch (instr->op) {
+          case OP_ADD_DOUBLE: lhs.set(l_val + r_val); break;
+          case OP_SUB_DOUBLE: lhs.set(l_val - r_val); break;
+          case OP_MUL_DOUBLE: lhs.set(l_val * r_val); break;
+          case OP_DIV_DOUBLE: lhs.set(l_val / r_val); break;
+          case OP_LT_DOUBLE: lhs.set(l_val < r_val); break;
+          case OP_LE_DOUBLE: lhs.set(l_val <= r_val); break;
+          case OP_GT_DOUBLE: lhs.set(l_val > r_val); break;
+          default: lhs.set(l_val >= r_val); break;
+        }
+        DISPATCH();
+      }
+
+      TARGET(OP_CONCAT) {
+        DataObject& lhs = stack[stack.size() - 2];
+        if (!lhs.append(stack.back()))
+          binary_op(OP_ADD, lhs, stack.back(), *frame);
+        stack.pop_back();
+        DISPATCH();
+      }
+
+      TARGET(OP_NOT) {
+        bool val = false;
+        stack.back().value(val);
+        stack.back().set(!val);
+        DISPATCH();
+      }
+
+      TARGET(OP_NEG) {
+        DataObject& top = stack.back();
+        int i_val;
+        double d_val;
+        if (top.value(i_val))
+          top.set(-i_val);
+        else if (top.value(d_val))
+          top.set(-d_val);
+        DISPATCH();
+      }
+
+      TARGET(OP_JUMP)
+        frame->ip = instr->arg;
+        DISPATCH();
+
+      TARGET(OP_JUMP_IF_FALSE) {
+        bool cond = false;
+        pop().value(cond);
+        if (!cond)
+          frame->ip = instr->arg;
+        DISPATCH();
+      }
+
+      TARGET(OP_JUMP_IF_FALSE_KEEP) {
+        bool cond = true;
+        if (stack.back().value(cond) and !cond)
+          frame->ip = instr->arg;
+        DISPATCH();
+      }
+
+      TARGET(OP_JUMP_IF_TRUE_KEEP) {
+        bool cond = false;
+        if (stack.back().value(cond) and cond)
+          frame->ip = instr->arg;
+        DISPATCH();
+      }
+
+      // the loop variable and the bound (on top of the stack) are ints
+      TARGET(OP_FOR_ENTER) {
+        int var = 0, bound = 0;
+        stack[frame->base + instr->arg2].value(var);
+        stack.back().value(bound);
+        if (var > bound)
+          frame->ip = instr->arg;
+        DISPATCH();
+      }
+
+      TARGET(OP_FOR_NEXT) {
+        DataObject& var = stack[frame->base + instr->arg2];
+        int val = 0, bound = 0;
+        var.value(val);
+        stack.back().value(bound);
+        var.set(++val);
+        if (val <= bound)
+          frame->ip = instr->arg;
+        DISPATCH();
+      }
+
+      // superinstructions (see peephole.h); like the instructions they
+      // replace, they fall back to the generic operator on a nil
+      TARGET(OP_INC_LOCAL) TARGET(OP_DEC_LOCAL) {
+        DataObject& var = stack[frame->base + instr->arg];
+        bool inc = instr->op == OP_INC_LOCAL;
+        int val;
+        if (!var.value(val))
+          binary_op(inc ? OP_ADD : OP_SUB, var, DataObject(instr->arg2),
+                    *frame);
+        else
+          var.set(inc ? val + instr->arg2 : val - instr->arg2);
+        DISPATCH();
+      }
+
+      TARGET(OP_LOAD_ADD_CONST) TARGET(OP_LOAD_SUB_CONST) {
+        stack.push_back(stack[frame->base + instr->arg]);
+        DataObject& top = stack.back();
+        bool add = instr->op == OP_LOAD_ADD_CONST;
+        int val;
+        if (!top.value(val))
+          binary_op(add ? OP_ADD : OP_SUB, top, DataObject(instr->arg2),
+                    *frame);
+        else
+          top.set(add ? val + instr->arg2 : val - instr->arg2);
+        DISPATCH();
+      }
+
+      TARGET(OP_LOAD_FIELD) {
+        size_t oid = 0;
+        HeapObject* obj = nullptr;
+        if (!stack[frame->base + instr->arg].value(oid) or
+            !(obj = heap.get_obj(oid)))
+          error("no attribute name ", *frame);
+        stack.push_back(obj->get_field(field_offset(instr->arg2, *obj)));
+        DISPATCH();
+      }
+
+      TARGET(OP_STORE_FIELD) {
+        size_t oid = 0;
+        HeapObject* obj = nullptr;
+        if (!stack[frame->base + instr->arg].value(oid) or
+            !(obj = heap.get_obj(oid)))
+          error("no attribute name", *frame);
+        heap.set_field(*obj, field_offset(instr->arg2, *obj), pop());
+        DISPATCH();
+      }
+
+      TARGET(OP_CMP_JUMP_INT) {
+        DataObject& lhs = stack[stack.size() - 2];
+        int l_val, r_val;
+        bool cond = false;
+        if (!lhs.value(l_val) or !stack.back().value(r_val)) {
+          binary_op(generic_op((OpCode) instr->arg2), lhs, stack.back(),
+                    *frame);
+          lhs.value(cond);
+        }
+        else {
+          switch (instr->arg2) {
+            case OP_EQ_INT: cond = l_val == r_val; break;
+            case OP_NE_INT: cond = l_val != r_val; break;
+            case OP_LT_INT: cond = l_val < r_val; break;
+            case OP_LE_INT: cond = l_val <= r_val; break;
+            case OP_GT_INT: cond = l_val > r_val; break;
+            default: cond = l_val >= r_val; break;
+          }
+        }
+        stack.resize(stack.size() - 2);
+        if (!cond)
+          frame->ip = instr->arg;
+        DISPATCH();
+      }
+
+      // the arguments already on the stack become the callee's first
+      // slots; the remaining locals start out nil
+      TARGET(OP_CALL) {
+        if (frames.size() == max_depth)
+          error("stack overflow: more than " + std::to_string(max_depth) +
+                " active calls", *frame);
+        const CodeObject* callee = &program.functions[instr->arg];
+        size_t base = stack.size() - callee->num_params;
+        stack.resize(base + callee->num_locals);
+        frames.push_back(Frame{callee, 0, base});
+        frame = &frames.back();
+        if (profiler and !callee->is_init)
+          profiler->enter(callee->name);
+        DISPATCH();
+      }
+
+      // the arguments move down to the caller's first slots and the
+      // callee runs in the caller's frame
+      TARGET(OP_TAIL_CALL) {
+        const CodeObject* callee = &program.functions[instr->arg];
+        size_t args = stack.size() - callee->num_params;
+        if (args != frame->base)
+          std::move(stack.begin() + args, stack.end(),
+                    stack.begin() + frame->base);
+        stack.resize(frame->base + callee->num_params);
+        stack.resize(frame->base + callee->num_locals);
+        if (profiler) {
+          profiler->exit();
+          profiler->enter(callee->name);
+        }
+        frame->code = callee;
+        frame->ip = 0;
+        DISPATCH();
+      }
+
+      TARGET(OP_RET) {
+        if (profiler and !frame->code->is_init)
+          profiler->exit();
+        // the return value takes the place of the callee's slot 0
+        size_t base = frame->base;
+        frames.pop_back();
+        if (frames.empty())
+          return;
+        std::swap(stack[base], stack.back());
+        stack.resize(base + 1);
+        frame = &frames.back();
+        DISPATCH();
+      }
+
+      TARGET(OP_PRINT)
+        print(stack.back());
+        stack.back().set_nil();
+        DISPATCH();
+
+      TARGET(OP_STOI)
+        try {
+          stack.back().set(std::stoi(stack.back().to_string()));
+        }
+        catch (const std::invalid_argument& e) {
+          error("internal error", *frame);
+        }
+        catch (const std::out_of_range& e) {
+          error("int out of range", *frame);
+        }
+        DISPATCH();
+
+      TARGET(OP_STOD)
+        try {
+          stack.back().set(std::stod(stack.back().to_string()));
+        }
+        catch (const std::invalid_argument& e) {
+          error("internal error", *frame);
+        }
+        catch (const std::out_of_range& e) {
+          error("int out of range", *frame);
+        }
+        DISPATCH();
+
+      TARGET(OP_ITOS) {
+        int val = 0;
+        stack.back().value(val);
+        stack.back().set(std::to_string(val));
+        DISPATCH();
+      }
+
+      TARGET(OP_DTOS) {
+        double val = 0.0;
+        stack.back().value(val);
+        stack.back().set(std::to_string(val));
+        DISPATCH();
+      }
+
+      TARGET(OP_GET)
+        get(*frame);
+        DISPATCH();
+
+      TARGET(OP_LENGTH)
+        stack.back().set((int)stack.back().to_string().length());
+        DISPATCH();
+
+      TARGET(OP_READ)
+        stack.push_back(DataObject());
+        read(stack.back());
+        DISPATCH();
+    }
+  }
+}
+
+#undef TARGET
+#undef DISPATCH
+
+
+void VM::print(const DataObject& val)
+{
+  std::string s = val.to_string();
+  std::cout.write(s.data(), s.size());
+  if (line_flush and s.find('\n') != std::string::npos)
+    std::cout.flush();
+}
+
+
+// get(i, s): the string is on top of the index
+void VM::get(const Frame& frame)
+{
+  std::string str;
+  pop().value(str);
+  int i = 0;
+  stack.back().value(i);
+  if (i < 0 or i >= (int) str.length())
+    error("int out of range", frame);
+  stack.back().set(std::string(1, str[i]));
+}
+
+
+void VM::read(DataObject& val)
+{
+  std::string str;
+  std::cin >> str;
+  val.set(std::move(str));
+}
+
+
+// apply a binary operator, leaving the result in lhs (same semantics,
+// including nil handling and error messages, as the tree walker)
+void VM::binary_op(OpCode op, DataObject& lhs, const DataObject& rhs,
+                   const Frame& frame)
+{
+  bool nil = lhs.is_nil() or rhs.is_nil();
+  if (op == OP_EQ or op == OP_NE) {
+    bool equal;
+    if (lhs.is_nil() or rhs.is_nil())
+      equal = lhs.is_nil() and rhs.is_nil();
+    else
+      equal = lhs.to_string() == rhs.to_string();
+    lhs.set(op == OP_EQ ? equal : !equal);
+    return;
+  }
+  if (op == OP_AND or op == OP_OR) {
+    if (nil)
+      error(op == OP_AND ? "can't use AND with a nil" : "can't use OR with a nil",
+            frame);
+    bool l_val = false, r_val = false;
+    lhs.value(l_val);
+    rhs.value(r_val);
+    lhs.set(op == OP_AND ? (l_val and r_val) : (l_val or r_val));
+    return;
+  }
+  if (nil) {
+    switch (op) {
+      case OP_ADD: error("cant do operation on nil value", frame);
+      case OP_SUB: error("cant do minus operation on a nil value", frame);
+      case OP_MUL: error("cant do multiplication operation on a nil value", frame);
+      case OP_DIV: error("cant do division operation on a nil value", frame);
+      case OP_MOD: error("cant do modulo operation on a nil value", frame);
+      default: error("cant do operation on nil", frame);
+    }
+  }
+  if (lhs.is_integer()) {
+    int l_val = 0, r_val = 0;
+    lhs.value(l_val);
+    rhs.value(r_val);
+    switch (op) {
+      case OP_ADD: lhs.set(l_val + r_val); break;
+      case OP_SUB: lhs.set(l_val - r_val); break;
+      case OP_MUL: lhs.set(l_val * r_val); break;
+      case OP_DIV: lhs.set(l_val / r_val); break;
+      case OP_MOD: lhs.set(l_val % r_val); break;
+      case OP_LT: lhs.set(l_val < r_val); break;
+      case OP_LE: lhs.set(l_val <= r_val); break;
+      case OP_GT: lhs.set(l_val > r_val); break;
+      case OP_GE: lhs.set(l_val >= r_val); break;
+      default: break;
+    }
+  }
+  else if (lhs.is_double()) {
+    double l_val = 0.0, r_val = 0.0;
+    lhs.value(l_val);
+    rhs.value(r_val);
+    switch (op) {
+      case OP_ADD: lhs.set(l_val + r_val); break;
+      case OP_SUB: lhs.set(l_val - r_val); break;
+      case OP_MUL: lhs.set(l_val * r_val); break;
+      case OP_DIV: lhs.set(l_val / r_val); break;
+      case OP_LT: lhs.set(l_val < r_val); break;
+      case OP_LE: lhs.set(l_val <= r_val); break;
+      case OP_GT: lhs.set(l_val > r_val); break;
+      case OP_GE: lhs.set(l_val >= r_val); break;
+      default: break;
+    }
+  }
+  else if (op == OP_ADD) {
+    // string concatenation (chars are promoted to strings)
+    if ((lhs.is_string() or lhs.is_char()) and
+        (rhs.is_string() or rhs.is_char())) {
+      std::string l_val, r_val;
+      char c;
+      if (!lhs.value(l_val) and lhs.value(c))
+        l_val = c;
+      if (!rhs.value(r_val) and rhs.value(c))
+        r_val = c;
+      lhs.set(l_val + r_val);
+    }
+    else
+      lhs = rhs;
+  }
+  else if (lhs.is_char()) {
+    char l_val = 0, r_val = 0;
+    lhs.value(l_val);
+    rhs.value(r_val);
+    switch (op) {
+      case OP_LT: lhs.set(l_val < r_val); break;
+      case OP_LE: lhs.set(l_val <= r_val); break;
+      case OP_GT: lhs.set(l_val > r_val); break;
+      case OP_GE: lhs.set(l_val >= r_val); break;
+      default: break;
+    }
+  }
+  else if (lhs.is_string()) {
+    std::string l_val, r_val;
+    lhs.value(l_val);
+    rhs.value(r_val);
+    switch (op) {
+      case OP_LT: lhs.set(l_val < r_val); break;
+      case OP_LE: lhs.set(l_val <= r_val); break;
+      case OP_GT: lhs.set(l_val > r_val); break;
+      case OP_GE: lhs.set(l_val >= r_val); break;
+      default: break;
+    }
+  }
+}
+
+
+#endif